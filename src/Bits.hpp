@@ -0,0 +1,146 @@
+/**
+ * \file
+ * \brief Word level bit operations used by the packed taxon storage
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef BITS_HPP_
+#define BITS_HPP_
+
+#include "def.hpp"
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace bits
+{
+
+/// storage word of a packed taxon
+typedef uint64_t word_t;
+
+/// number of bits in a storage word
+constexpr std::size_t word_bits = 64;
+
+/// number of words needed to store n bits
+constexpr std::size_t words (const std::size_t n) noexcept
+{
+	return (n + word_bits - 1) / word_bits;
+}
+
+/// number of set bits in a word
+inline std::size_t popcount (const word_t x) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	return (std::size_t) __popcnt64(x);
+#else
+	return (std::size_t) __builtin_popcountll(x);
+#endif
+}
+
+/// index of the lowest set bit, x must not be 0
+inline std::size_t ctz (const word_t x) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long i;
+	_BitScanForward64(&i, x);
+	return (std::size_t) i;
+#else
+	return (std::size_t) __builtin_ctzll(x);
+#endif
+}
+
+/// number of leading zero bits, x must not be 0
+inline std::size_t clz (const word_t x) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long i;
+	_BitScanReverse64(&i, x);
+	return word_bits - 1 - (std::size_t) i;
+#else
+	return (std::size_t) __builtin_clzll(x);
+#endif
+}
+
+/// mask for the used bits of the last word of a n bit string
+constexpr word_t tail (const std::size_t n) noexcept
+{
+	return (n % word_bits) ? ((word_t(1) << (n % word_bits)) - 1) : ~word_t(0);
+}
+
+/*
+ * Kernels on packed bit strings. W is the number of words if it is known at
+ * compile time, the loops are then fully unrolled. W = 0 selects the runtime
+ * length n.
+ */
+
+/// number of words processed by a kernel
+template <std::size_t W>
+constexpr std::size_t span (const std::size_t n) noexcept
+{
+	return W ? W : n;
+}
+
+/// test bit pos
+inline bool at (const word_t* __restrict a, const std::size_t pos) noexcept
+{
+	return (a[pos / word_bits] >> (pos % word_bits)) & 1;
+}
+
+/// flip bit pos
+inline void flip (word_t* __restrict a, const std::size_t pos) noexcept
+{
+	a[pos / word_bits] ^= word_t(1) << (pos % word_bits);
+}
+
+/// a is smaller if it has the set bit at the first diverging position
+template <std::size_t W>
+inline bool less (const word_t* __restrict a, const word_t* __restrict b, const std::size_t n = W) noexcept
+{
+	for (std::size_t i = 0; i < span<W>(n); i++)
+	{
+		const word_t x = a[i] ^ b[i];
+		if (x)
+			return (a[i] >> ctz(x)) & 1;
+	}
+	return false;
+}
+
+template <std::size_t W>
+inline bool equal (const word_t* __restrict a, const word_t* __restrict b, const std::size_t n = W) noexcept
+{
+	word_t x = 0;
+	for (std::size_t i = 0; i < span<W>(n); i++)
+		x |= a[i] ^ b[i];
+	return x == 0;
+}
+
+/// hamming distance
+template <std::size_t W>
+inline std::size_t distance (const word_t* __restrict a, const word_t* __restrict b, const std::size_t n = W) noexcept
+{
+	std::size_t d = 0;
+	for (std::size_t i = 0; i < span<W>(n); i++)
+		d += popcount(a[i] ^ b[i]);
+	return d;
+}
+
+/// first diverging bit, or -1 if a and b are equal
+template <std::size_t W>
+inline std::size_t difference (const word_t* __restrict a, const word_t* __restrict b, const std::size_t n = W) noexcept
+{
+	for (std::size_t i = 0; i < span<W>(n); i++)
+	{
+		const word_t x = a[i] ^ b[i];
+		if (x)
+			return i * word_bits + ctz(x);
+	}
+	return -1;
+}
+
+}
+
+#endif /* BITS_HPP_ */
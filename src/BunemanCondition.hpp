@@ -0,0 +1,159 @@
+/**
+ * \file
+ * \brief Buneman condition on pairs of characters
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef BUNEMANCONDITION_HPP_
+#define BUNEMANCONDITION_HPP_
+
+#include "def.hpp"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/dynamic_bitset.hpp>
+
+#include "Bits.hpp"
+
+/**
+ * A taxon is a vertex of the Buneman-Graph iff for every pair of characters
+ * (j, l) the states (v[j], v[l]) occur together in some input taxon. The
+ * table holds one byte per pair, bit 2a + b is set if the states (a, b)
+ * occur. It is built once from the terminals and read only afterwards, so
+ * any number of threads can check vertices without locking.
+ *
+ * For checking all neighbours of a vertex at once the table is also kept as
+ * bit masks: for character j in state a the set of characters l whose state
+ * b = 1 (resp. b = 0) does not occur together with it.
+ */
+template <std::size_t W>
+class BunemanCondition
+{
+public:
+	BunemanCondition (const std::size_t m) :
+			m(m),
+			stride(bits::span<W>(bits::words(m))),
+			columns(m)
+	{
+	}
+
+	/// add a taxon from the input
+	void insert (const bits::word_t* __restrict v)
+	{
+		for (std::size_t j = 0; j < m; j++)
+			columns[j].push_back(bits::at(v, j));
+	}
+
+	/// build the table from the inserted taxa
+	void build ()
+	{
+		// taxa in state 0 of every character
+		std::vector<boost::dynamic_bitset<>> complement(m);
+		for (std::size_t j = 0; j < m; j++)
+			complement[j] = ~columns[j];
+
+		table.assign(m * m, 0);
+		for (std::size_t j = 0; j < m; j++)
+		{
+			for (std::size_t l = 0; l < m; l++)
+			{
+				uint8_t& p = table[j * m + l];
+				if (complement[j].intersects(complement[l]))
+					p |= state(0, 0);
+				if (complement[j].intersects(columns[l]))
+					p |= state(0, 1);
+				if (columns[j].intersects(complement[l]))
+					p |= state(1, 0);
+				if (columns[j].intersects(columns[l]))
+					p |= state(1, 1);
+			}
+		}
+		columns.clear();
+		columns.shrink_to_fit();
+
+		absent.assign(4 * m * stride, 0);
+		for (std::size_t j = 0; j < m; j++)
+			for (std::size_t a = 0; a < 2; a++)
+			{
+				bits::word_t* one = mask(j, a);
+				bits::word_t* zero = one + stride;
+				for (std::size_t l = 0; l < m; l++)
+				{
+					if (l == j)
+						continue;
+					if (!present(j, a, l, true))
+						bits::flip(one, l);
+					if (!present(j, a, l, false))
+						bits::flip(zero, l);
+				}
+			}
+	}
+
+	/// test if the states a of character j and b of character l occur together
+	bool present (const std::size_t j, const bool a, const std::size_t l, const bool b) const noexcept
+	{
+		return table[j * m + l] & state(a, b);
+	}
+
+	/**
+	 * Set the bits of all characters j in out, for which flipping j in v gives
+	 * a taxon that passes the Buneman condition. out needs room for a taxon.
+	 */
+	void flips (const bits::word_t* __restrict v, bits::word_t* __restrict out) const noexcept
+	{
+		for (std::size_t i = 0; i < stride; i++)
+			out[i] = 0;
+		for (std::size_t j = 0; j < m; j++)
+		{
+			const bits::word_t* one = mask(j, !bits::at(v, j));
+			const bits::word_t* zero = one + stride;
+			bits::word_t x = 0;
+			for (std::size_t i = 0; i < bits::span<W>(stride); i++)
+				x |= (one[i] & v[i]) | (zero[i] & ~v[i]);
+			if (!x)
+				bits::flip(out, j);
+		}
+	}
+
+	/**
+	 * Implications of character j in state a: the first taxon sized block of
+	 * words holds the characters that have to be 0, the next block the ones
+	 * that have to be 1. These are the edges of the implication graph of the
+	 * 2-SAT formula with one clause per absent pair of states.
+	 */
+	const bits::word_t* implications (const std::size_t j, const bool a) const noexcept
+	{
+		return mask(j, a);
+	}
+
+private:
+	std::size_t m;
+	/// words per taxon
+	std::size_t stride;
+
+	/// characters of the input taxa, only used until build
+	std::vector<boost::dynamic_bitset<>> columns;
+	/// present states of each pair of characters
+	std::vector<uint8_t> table;
+	/// characters in conflict with state a of j, for a partner in state 1 and 0
+	std::vector<bits::word_t> absent;
+
+	bits::word_t* mask (const std::size_t j, const bool a) noexcept
+	{
+		return absent.data() + (2 * j + a) * 2 * stride;
+	}
+
+	const bits::word_t* mask (const std::size_t j, const bool a) const noexcept
+	{
+		return absent.data() + (2 * j + a) * 2 * stride;
+	}
+
+	static constexpr uint8_t state (const bool a, const bool b) noexcept
+	{
+		return uint8_t(1) << (2 * a + b);
+	}
+};
+
+#endif /* BUNEMANCONDITION_HPP_ */
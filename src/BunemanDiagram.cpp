@@ -0,0 +1,294 @@
+/**
+ * \file
+ * \brief
+ *
+ * \date 2026-10-17
+ */
+
+#include "def.hpp"
+#include "BunemanDiagram.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include <inttypes.h>
+
+using namespace std;
+
+/// sum of two counts, saturated at UINT64_MAX
+static inline uint64_t add (const uint64_t a, const uint64_t b)
+{
+	return a > numeric_limits<uint64_t>::max() - b ? numeric_limits<uint64_t>::max() : a + b;
+}
+
+BunemanDiagram::BunemanDiagram (const uint64_t m, const vector<uint64_t>& weight) :
+			m(m),
+			weight(weight),
+			root(bottom),
+			vertex_count(0),
+			edge_count(0)
+{
+	if (m >= numeric_limits<uint32_t>::max())
+	{
+		throw runtime_error("Too many haplotypes for the decision diagram");
+	}
+	const uint32_t terminal = (uint32_t) m;
+	nodes.push_back(node{terminal, bottom, bottom});
+	nodes.push_back(node{terminal, top, top});
+	count.push_back(0);
+	count.push_back(1);
+}
+
+BunemanDiagram::~BunemanDiagram ()
+{
+}
+
+BunemanDiagram::node_type BunemanDiagram::make (const uint32_t column, const node_type lo, const node_type hi)
+{
+	// a column that is always 0 is suppressed
+	if (hi == bottom)
+		return lo;
+	const node n{column, lo, hi};
+	auto it = unique.find(n);
+	if (it != unique.end())
+		return it->second;
+	if (nodes.size() >= max_nodes)
+	{
+		throw runtime_error("Decision diagram exceeds the node limit");
+	}
+	const node_type id = (node_type) nodes.size();
+	nodes.push_back(n);
+	count.push_back(add(count[lo], count[hi]));
+	unique.emplace(n, id);
+	return id;
+}
+
+BunemanDiagram::node_type BunemanDiagram::intersect (const node_type f, const node_type g)
+{
+	if (f == bottom || g == bottom)
+		return bottom;
+	if (f == g)
+		return f;
+	// the empty taxon is the end of the lo path
+	if (f == top || g == top)
+	{
+		node_type x = f == top ? g : f;
+		while (x > top)
+			x = nodes[x].lo;
+		return x;
+	}
+
+	const uint64_t key = f < g ? ((uint64_t) f << 32) | g : ((uint64_t) g << 32) | f;
+	auto it = cache.find(key);
+	if (it != cache.end())
+		return it->second;
+
+	// copies, make may move the nodes
+	const node a = nodes[f];
+	const node b = nodes[g];
+	node_type r;
+	// taxa with a column the other family never sets are not in both
+	if (a.column < b.column)
+		r = intersect(a.lo, g);
+	else if (a.column > b.column)
+		r = intersect(f, b.lo);
+	else
+	{
+		const node_type hi = intersect(a.hi, b.hi);
+		const node_type lo = intersect(a.lo, b.lo);
+		r = make(a.column, lo, hi);
+	}
+	cache.emplace(key, r);
+	return r;
+}
+
+BunemanDiagram::node_type BunemanDiagram::constraint (const size_t i, const vector<bits::word_t> present[2][2])
+{
+	// below column i the taxa are restricted by the value at i
+	node_type branch[2];
+	for (size_t a = 0; a < 2; a++)
+	{
+		node_type x = top;
+		for (size_t j = m - 1; j > i && x != bottom; j--)
+		{
+			const bool zero = bits::at(present[a][0].data(), j);
+			const bool one = bits::at(present[a][1].data(), j);
+			if (zero && one)
+				x = make((uint32_t) j, x, x);
+			else if (one)
+				x = make((uint32_t) j, bottom, x);
+			else if (!zero)
+				x = bottom;
+		}
+		branch[a] = x;
+	}
+	node_type x = make((uint32_t) i, branch[0], branch[1]);
+	// the columns before i are free
+	for (size_t j = i; j-- > 0;)
+		x = make((uint32_t) j, x, x);
+	return x;
+}
+
+void BunemanDiagram::build (const vector<Taxon>& taxa)
+{
+	if (taxa.empty())
+		throw logic_error("No taxa for the decision diagram");
+	const size_t s = bits::words(m);
+
+	// from the last column up, the families that are joined first only differ
+	// at the bottom of the diagram, so the intermediate diagrams stay small
+	root = bottom;
+	for (size_t i = m; i-- > 0;)
+	{
+		// values of the later columns next to each value of column i
+		vector<bits::word_t> present[2][2];
+		for (size_t a = 0; a < 2; a++)
+			for (size_t b = 0; b < 2; b++)
+				present[a][b].assign(s, 0);
+		for (const Taxon& t : taxa)
+		{
+			const bool a = t.at(i);
+			const bits::word_t* row = t.data();
+			for (size_t w = 0; w < s; w++)
+			{
+				present[a][0][w] |= ~row[w];
+				present[a][1][w] |= row[w];
+			}
+		}
+
+		const node_type c = constraint(i, present);
+		root = i == m - 1 ? c : intersect(root, c);
+		cache.clear();
+	}
+	if (m == 0)
+		root = top;
+
+	vertex_count = count[root];
+	if (vertex_count == numeric_limits<uint64_t>::max())
+	{
+		throw runtime_error("Too many vertices to count");
+	}
+	unordered_map<node_type, uint64_t> memo;
+	edge_count = connections(root, memo);
+	cache.clear();
+	if (edge_count == numeric_limits<uint64_t>::max())
+	{
+		throw runtime_error("Too many edges to count");
+	}
+
+	terminal.clear();
+	terminal.reserve(taxa.size());
+	for (const Taxon& t : taxa)
+	{
+		uint64_t r;
+		if (!rank(t, r))
+			throw logic_error("Terminal is no vertex of the decision diagram");
+		terminal.push_back(r);
+	}
+	sort(terminal.begin(), terminal.end());
+}
+
+uint64_t BunemanDiagram::connections (const node_type f, unordered_map<node_type, uint64_t>& memo)
+{
+	if (f <= top)
+		return 0;
+	auto it = memo.find(f);
+	if (it != memo.end())
+		return it->second;
+	// the edges of a column join the taxa that are in both children
+	const node n = nodes[f];
+	uint64_t r = count[intersect(n.lo, n.hi)];
+	r = add(r, connections(n.lo, memo));
+	r = add(r, connections(n.hi, memo));
+	memo.emplace(f, r);
+	return r;
+}
+
+bool BunemanDiagram::rank (const Taxon& v, uint64_t& r) const
+{
+	node_type x = root;
+	r = 0;
+	for (size_t j = 0; j < m; j++)
+	{
+		const node& n = nodes[x];
+		if (x <= top || n.column > j)
+		{
+			// the column is suppressed on this path
+			if (v.at(j))
+				return false;
+			continue;
+		}
+		if (v.at(j))
+			x = n.hi;
+		else
+		{
+			r += count[n.hi];
+			x = n.lo;
+		}
+	}
+	return x == top;
+}
+
+void BunemanDiagram::generate ()
+{
+}
+
+void BunemanDiagram::connect ()
+{
+}
+
+size_t BunemanDiagram::vertices () const
+{
+	return vertex_count;
+}
+
+size_t BunemanDiagram::edges () const
+{
+	return edge_count;
+}
+
+size_t BunemanDiagram::size () const
+{
+	return nodes.size();
+}
+
+void BunemanDiagram::write_edges (FILE* __restrict fp) const
+{
+	// the endpoint with the bit set comes first, as in the Buneman-Graph
+	for_each([this, fp] (Taxon& v, const uint64_t r)
+	{
+		for (size_t j = 0; j < m; j++)
+		{
+			if (!v.at(j))
+				continue;
+			v.flip(j);
+			uint64_t u;
+			if (rank(v, u))
+				fprintf(fp, "E %" PRIu64 " %" PRIu64 " %" PRIu64 "\n", r + 1, u + 1, weight[j]);
+			v.flip(j);
+		}
+	});
+}
+
+void BunemanDiagram::write_terminals (FILE* __restrict fp) const
+{
+	for (uint64_t r : terminal)
+		fprintf(fp, "T %" PRIu64 "\n", r + 1);
+}
+
+void BunemanDiagram::write_vertices (FILE* __restrict fp) const
+{
+	auto t = terminal.begin();
+	for_each([this, fp, &t] (const Taxon& v, const uint64_t r)
+	{
+		const bool is_terminal = t != terminal.end() && *t == r;
+		if (is_terminal)
+			t++;
+		fprintf(fp, "%" PRIu64 "\t", r + 1);
+		for (size_t j = 0; j < m; j++)
+			fputc(v.at(j) ? '1' : '0', fp);
+		fprintf(fp, (is_terminal ? "\tterminal" : ""));
+		fputc('\n', fp);
+	});
+}
@@ -0,0 +1,155 @@
+/**
+ * \file
+ * \brief Buneman-Graph as a zero-suppressed decision diagram
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef BUNEMANDIAGRAM_HPP_
+#define BUNEMANDIAGRAM_HPP_
+
+#include "def.hpp"
+#include <cstdio>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+#include "Graph.hpp"
+#include "Taxon.hpp"
+
+/**
+ * The vertices of the Buneman-Graph are the taxa that show, for every pair of
+ * columns, only state pairs that occur in the input. Each absent pair excludes
+ * the taxa showing it, so the vertex set is the intersection of one family of
+ * taxa per column, built as a zero-suppressed decision diagram (ZDD) with the
+ * columns as variables. A taxon is the set of its columns with a 1.
+ *
+ * The diagram is usually far smaller than the graph. The numbers of vertices
+ * and edges are counted on it exactly, and the writers walk the vertices in
+ * their output order without storing them: the index of a vertex is its rank
+ * in the diagram, so the edges are found by ranking the neighbours.
+ */
+class BunemanDiagram : public Graph
+{
+public:
+	/// largest number of diagram nodes before build gives up
+	static constexpr std::size_t max_nodes = std::size_t(1) << 24;
+
+	BunemanDiagram (const uint64_t m, const std::vector<uint64_t>& weight);
+	virtual ~BunemanDiagram ();
+
+	/// build the diagram of the taxa and count the graph
+	void build (const std::vector<Taxon>&);
+
+	/// the diagram is complete after build
+	void generate ();
+	/// the edges are only found when they are written
+	void connect ();
+
+	std::size_t vertices () const;
+	std::size_t edges () const;
+
+	/// number of nodes of the diagram
+	std::size_t size () const;
+
+	void write_edges (FILE* __restrict) const;
+	void write_terminals (FILE* __restrict) const;
+	void write_vertices (FILE* __restrict) const;
+
+private:
+	typedef uint32_t node_type;
+
+	/// the empty family and the family of the empty taxon
+	static constexpr node_type bottom = 0;
+	static constexpr node_type top = 1;
+
+	struct node
+	{
+		/// column of the node, m for the terminals
+		uint32_t column;
+		/// taxa without and with the column
+		node_type lo;
+		node_type hi;
+
+		bool operator== (const node& other) const noexcept
+		{
+			return column == other.column && lo == other.lo && hi == other.hi;
+		}
+	};
+
+	struct node_hash
+	{
+		std::size_t operator() (const node& n) const noexcept
+		{
+			return (((uint64_t) n.column * 0x9E3779B97F4A7C15ULL + n.lo) * 0x9E3779B97F4A7C15ULL + n.hi) >> 7;
+		}
+	};
+
+	/// Length of each Taxon
+	uint64_t m;
+
+	std::vector<uint64_t> weight;
+
+	std::vector<node> nodes;
+	/// nodes by their column and children
+	std::unordered_map<node, node_type, node_hash> unique;
+	/// results of intersect, only valid during one build
+	std::unordered_map<uint64_t, node_type> cache;
+	/// number of taxa below every node, UINT64_MAX if they do not fit
+	std::vector<uint64_t> count;
+
+	node_type root;
+
+	uint64_t vertex_count;
+	uint64_t edge_count;
+
+	/// rank of every terminal, sorted
+	std::vector<uint64_t> terminal;
+
+	/// node for the given column and children, shared if it exists
+	node_type make (const uint32_t column, const node_type lo, const node_type hi);
+	/// taxa in both families
+	node_type intersect (const node_type f, const node_type g);
+	/// family of all taxa that show at column i only pairs from present
+	node_type constraint (const std::size_t i, const std::vector<bits::word_t> present[2][2]);
+	/// number of edges between the taxa of f
+	uint64_t connections (const node_type f, std::unordered_map<node_type, uint64_t>& memo);
+
+	/// rank of v in the output order, false if it is no vertex
+	bool rank (const Taxon& v, uint64_t& r) const;
+
+	/// call f(v, rank) for every vertex in output order
+	template <class F>
+	void for_each (F f) const
+	{
+		// columns with a 1 come first, so every node lists hi before lo
+		std::vector<std::pair<node_type, uint32_t>> stack;
+		Taxon v(m);
+		uint64_t r = 0;
+		stack.emplace_back(root, 0);
+		while (!stack.empty())
+		{
+			const node_type x = stack.back().first;
+			const uint32_t column = stack.back().second;
+			stack.pop_back();
+			// clear the columns below the node that led here
+			for (std::size_t j = column; j < m; j++)
+				v.set(j, false);
+			if (x == bottom)
+				continue;
+			if (x == top)
+			{
+				f(v, r++);
+				continue;
+			}
+			const node& n = nodes[x];
+			stack.emplace_back(n.lo, n.column);
+			stack.emplace_back(n.hi, n.column + 1);
+			v.set(n.column, true);
+		}
+	}
+};
+
+#endif /* BUNEMANDIAGRAM_HPP_ */
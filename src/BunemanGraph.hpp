@@ -0,0 +1,886 @@
+/**
+ * \file
+ * \brief Generation of the Buneman-Graph for a fixed taxon representation
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef BUNEMANGRAPH_HPP_
+#define BUNEMANGRAPH_HPP_
+
+#include "def.hpp"
+#include <cstdio>
+#include <stdexcept>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <shared_mutex>
+#include <cstddef>
+#include <cstdint>
+
+#include <inttypes.h>
+
+#include "Console.hpp"
+#include "Graph.hpp"
+#include "Options.hpp"
+#include "ThreadPool.hpp"
+#include "WorkStealingPool.hpp"
+#include "Taxon.hpp"
+#include "FixedTaxon.hpp"
+#include "Zobrist.hpp"
+#include "TaxonStore.hpp"
+#include "NodeIndex.hpp"
+#include "OrderedNodeIndex.hpp"
+#include "BunemanCondition.hpp"
+#include "EdgeBuffer.hpp"
+
+/**
+ * Buneman-Graph with vertices of type T. T is either a FixedTaxon, if the
+ * reduced taxa fit into a few words, or the dynamic Taxon as fallback.
+ *
+ * The bits of all vertices are kept in a TaxonStore, everything else refers
+ * to a vertex by its 32 bit id. The terminals are inserted first and get the
+ * ids 0 .. terminals - 1. Membership is tested in the index I, either the
+ * sharded hash index on the Zobrist fingerprint of a vertex (NodeIndex), in
+ * which case the order of the output is only established by connect, or the
+ * concurrent B-tree (OrderedNodeIndex) that keeps the vertices sorted.
+ *
+ * Edges are stored as records of type E, which refer to their column with a
+ * 16 bit Edge or, for more than EDGE_MAX_COLUMNS columns, with a WideEdge.
+ */
+template <class T, template <std::size_t> class I = NodeIndex, class E = Edge>
+class BunemanGraph : public Graph
+{
+public:
+	typedef T taxon_type;
+	/// words per taxon, 0 if only known at runtime
+	static constexpr std::size_t W = T::Words;
+	typedef TaxonStore<W> store_type;
+	typedef typename store_type::id_type vertex_type;
+
+	BunemanGraph (const uint64_t m, const std::vector<uint64_t>& weight, const Options& options);
+	virtual ~BunemanGraph ();
+
+	/// add a taxon from the input
+	void insert (const Taxon&);
+
+	void generate ();
+	void connect ();
+
+	std::size_t vertices () const;
+	std::size_t edges () const;
+
+	void write_edges (FILE* __restrict) const;
+	void write_terminals (FILE* __restrict) const;
+	void write_vertices (FILE* __restrict) const;
+
+private:
+	/// Order of the vertices in the output
+	struct less
+	{
+	public:
+		const store_type* store;
+
+		inline bool operator() (const vertex_type lhs, const vertex_type rhs) const noexcept
+		{
+			return bits::less<W>((*store)[lhs], (*store)[rhs], store->words());
+		}
+	};
+
+	/// Set of nodes
+	typedef I<W> node_set;
+	/// List of generated edges
+	typedef EdgeBuffer<E> edge_list;
+
+	Options options;
+
+	/// Length of each Taxon
+	uint64_t m;
+
+	std::vector<uint64_t> weight;
+
+	/// Taxon from the input
+	uint64_t terminals;
+
+	store_type store;
+	node_set nodes;
+	edge_list edge;
+
+	/// vertices in the order of their index, set by connect
+	std::vector<vertex_type> order;
+	/// index of each vertex id, set by connect
+	std::vector<uint64_t> index;
+
+
+	/// pairs of states present in the input
+	BunemanCondition<W> buneman;
+
+	/// flip breadth first search from the terminals
+	void expand (WorkStealingPool<vertex_type>&, std::atomic<uint64_t>&);
+	/// enumerate the solutions of the 2-SAT formula of the Buneman condition
+	void enumerate (WorkStealingPool<vertex_type>&, std::atomic<uint64_t>&);
+	/// reverse search from the terminals along canonical parents
+	void search (WorkStealingPool<vertex_type>&, std::atomic<uint64_t>&);
+	/// add the columns one at a time, splitting the vertices in conflict with a column
+	void split (std::atomic<uint64_t>&);
+	/// add the medians of all triples of vertices until nothing changes
+	void close (WorkStealingPool<vertex_type>&, std::atomic<uint64_t>&);
+	/// column to flip for the canonical parent of v, which is d from the nearest terminal
+	std::size_t parent (const bits::word_t* __restrict v, const std::vector<std::size_t>& distance, const std::size_t d, taxon_type& f, std::vector<bits::word_t>& toward) const;
+	/// set character j to a and apply unit propagation, false on a conflict
+	bool propagate (bits::word_t* __restrict value, bits::word_t* __restrict fixed, const std::size_t j, const bool a, std::vector<std::size_t>& pending) const;
+	/// first character that is not fixed, m if all are
+	std::size_t unfixed (const bits::word_t* __restrict fixed) const noexcept;
+};
+
+template <class T, template <std::size_t> class I, class E>
+BunemanGraph<T, I, E>::BunemanGraph (const uint64_t m, const std::vector<uint64_t>& weight, const Options& options) :
+			options(options),
+			m(m),
+			weight(weight),
+			terminals(0),
+			store(bits::words(m)),
+			nodes(store),
+			buneman(m)
+{
+	// the loader picks a WideEdge for wide matrices
+	if (m && m - 1 > std::numeric_limits<typename E::column_type>::max())
+	{
+		throw std::logic_error("Edge record too narrow for the haplotypes");
+	}
+}
+
+template <class T, template <std::size_t> class I, class E>
+BunemanGraph<T, I, E>::~BunemanGraph ()
+{
+}
+
+template <class T, template <std::size_t> class I, class E>
+void BunemanGraph<T, I, E>::insert (const Taxon& t)
+{
+	// the index compares whole rows, so pad the taxon to the width of the store
+	std::vector<bits::word_t> row(store.words(), 0);
+	std::copy(t.data(), t.data() + std::min(t.words(), store.words()), row.begin());
+	auto inserted = nodes.insert(row.data(), t.hash(), [this, &row, &t] ()
+	{
+		return store.append(row.data(), store.words(), t.hash());
+	});
+	if (!inserted.second)
+		return;
+	buneman.insert(row.data());
+	terminals++;
+}
+
+template <class T, template <std::size_t> class I, class E>
+std::size_t BunemanGraph<T, I, E>::vertices () const
+{
+	return nodes.size();
+}
+
+template <class T, template <std::size_t> class I, class E>
+std::size_t BunemanGraph<T, I, E>::edges () const
+{
+	return edge.size();
+}
+
+template <class T, template <std::size_t> class I, class E>
+void BunemanGraph<T, I, E>::generate ()
+{
+	using namespace std;
+
+	atomic<uint64_t> generated(0);
+
+	struct output_t
+	{
+		mutex mx;
+		condition_variable monitor;
+		bool condition = false;
+	};
+	output_t output;
+
+	buneman.build();
+
+	WorkStealingPool<vertex_type> p(options.workers());
+
+	const auto progress = [&output, &p, &generated] ()
+	{
+		uint64_t last = 0;
+		while (true)
+		{
+			unique_lock<decltype(output.mx)> lock(output.mx);
+			// the predicate catches a notification sent before the wait
+			output.monitor.wait_for(lock, OUTPUT_TIMEOUT, [&output] () { return output.condition; });
+
+			if (is_terminal())
+			{
+				goto_beginning_of_line();
+			}
+			const uint64_t g = generated;
+			printf("%10" PRIu64 ": queued: %10zu    V/s: %5" PRIu64, g, p.queued(), (g-last) * OUTPUT_MULTIPLIER);
+			last = g;
+			if (is_terminal())
+				fflush(stdout);
+			else
+				printf("\n");
+
+			if (output.condition)
+				break;
+		}
+	};
+	thread output_thread;
+	if (options.progress)
+		output_thread = thread(progress);
+	// the progress thread has to end before an error of an engine leaves
+	const auto stop = [&output, &output_thread] ()
+	{
+		{
+			unique_lock<decltype(output.mx)> lock(output.mx);
+			output.condition = true;
+			output.monitor.notify_one();
+		}
+		if (output_thread.joinable())
+			output_thread.join();
+	};
+
+	try
+	{
+		if (options.generator == Options::Generator::sat)
+		{
+			enumerate(p, generated);
+		}
+		else if (options.generator == Options::Generator::reverse)
+		{
+			search(p, generated);
+		}
+		else if (options.generator == Options::Generator::split)
+		{
+			split(generated);
+		}
+		else if (options.generator == Options::Generator::median)
+		{
+			close(p, generated);
+		}
+		else
+		{
+			for (vertex_type v = 0; v < terminals; v++)
+			{
+				p.push(v);
+			}
+			expand(p, generated);
+		}
+	}
+	catch (...)
+	{
+		stop();
+		throw;
+	}
+	stop();
+	if (!options.progress)
+		return;
+	printf("\n");
+
+	printf("Generated %" PRIu64 " latent taxas. ", generated.load());
+	fflush(stdout);
+}
+
+template <class T, template <std::size_t> class I, class E>
+void BunemanGraph<T, I, E>::expand (WorkStealingPool<vertex_type>& p, std::atomic<uint64_t>& generated)
+{
+	using namespace std;
+
+	// edges found while expanding, one list per worker
+	vector<edge_list> found(options.connect == Options::Connect::fused ? p.threads() : 0);
+
+	// new vertices go into the deque of the worker that found them
+	p.run([this, &p, &generated, &found] (const vertex_type v)
+	{
+		// scratch space of this thread, the candidates are flipped in place
+		thread_local taxon_type v1, f;
+		v1.assign(store[v], m);
+		f.assign(store[v], m);
+
+		// all neighbours passing the Buneman condition
+		buneman.flips(v1.data(), f.data());
+		for (size_t w = 0; w < store.words(); w++)
+			for (bits::word_t x = f.data()[w]; x; x &= x - 1)
+			{
+				const size_t j = w * bits::word_bits + bits::ctz(x);
+				v1.flip(j);
+				// only materialize the taxon if it is new
+				auto inserted = nodes.insert(v1.data(), v1.hash(), [this] ()
+				{
+					return store.append(v1.data(), store.words(), v1.hash());
+				});
+				if (inserted.second)
+				{
+					p.push(inserted.first);
+					generated++;
+				}
+				v1.flip(j);
+				// every vertex is expanded once, so taking only the edges to the
+				// smaller neighbour (bit j set) records each edge once
+				if (!found.empty() && !v1[j])
+					found[p.worker()].emplace_back(inserted.first, v, j);
+			}
+	});
+
+	for (edge_list& e : found)
+		edge.splice(e);
+}
+
+template <class T, template <std::size_t> class I, class E>
+void BunemanGraph<T, I, E>::search (WorkStealingPool<vertex_type>& p, std::atomic<uint64_t>& generated)
+{
+	using namespace std;
+
+	// The Buneman-Graph is an isometric subgraph of the hypercube, so every
+	// vertex that is not a terminal has a neighbour one step closer to its
+	// nearest terminals. The canonical parent is the one reached by the lowest
+	// such column, which makes the vertices a forest below the terminals. A
+	// neighbour is only expanded if this vertex is its parent, so every vertex
+	// is found once and no shared set is asked during the search.
+	for (vertex_type v = 0; v < terminals; v++)
+	{
+		p.push(v);
+	}
+
+	p.run([this, &p, &generated] (const vertex_type u)
+	{
+		thread_local taxon_type w, f, g;
+		thread_local vector<size_t> distance, next;
+		thread_local vector<bits::word_t> toward;
+		const size_t s = store.words();
+		const bits::word_t* row = store[u];
+
+		// distance to every terminal
+		distance.resize(terminals);
+		next.resize(terminals);
+		size_t d = numeric_limits<size_t>::max();
+		for (vertex_type t = 0; t < terminals; t++)
+		{
+			distance[t] = bits::distance<W>(row, store[t], s);
+			d = min(d, distance[t]);
+		}
+
+		w.assign(row, m);
+		f.assign(row, m);
+		buneman.flips(w.data(), f.data());
+		for (size_t i = 0; i < s; i++)
+			for (bits::word_t x = f.data()[i]; x; x &= x - 1)
+			{
+				const size_t j = i * bits::word_bits + bits::ctz(x);
+				const bool a = bits::at(row, j);
+
+				// only neighbours one step further away can be children
+				size_t e = numeric_limits<size_t>::max();
+				for (vertex_type t = 0; t < terminals; t++)
+				{
+					next[t] = bits::at(store[t], j) == a ? distance[t] + 1 : distance[t] - 1;
+					e = min(e, next[t]);
+				}
+				if (e != d + 1)
+					continue;
+
+				w.flip(j);
+				if (parent(w.data(), next, e, g, toward) == j)
+				{
+					auto inserted = nodes.insert(w.data(), w.hash(), [this] ()
+					{
+						return store.append(w.data(), store.words(), w.hash());
+					});
+					if (inserted.second)
+					{
+						p.push(inserted.first);
+						generated++;
+					}
+				}
+				w.flip(j);
+			}
+	});
+}
+
+template <class T, template <std::size_t> class I, class E>
+void BunemanGraph<T, I, E>::split (std::atomic<uint64_t>& generated)
+{
+	using namespace std;
+
+	const size_t s = store.words();
+	const uint32_t none = numeric_limits<uint32_t>::max();
+
+	// The graph on the columns before c, its vertices are rows with the
+	// columns from c on cleared. Adding column c keeps the vertices that are
+	// compatible with one state of c and doubles the ones compatible with
+	// both; the copies are joined by an edge of column c, and an edge between
+	// two vertices survives for every state both of them take.
+	vector<bits::word_t> rows(s, 0), next;
+	vector<E> links, joined;
+	vector<uint32_t> copies[2];
+	size_t count = 1;
+	for (size_t c = 0; c < m; c++)
+	{
+		const size_t word = c / bits::word_bits;
+		const bits::word_t before = (bits::word_t(1) << (c % bits::word_bits)) - 1;
+		next.clear();
+		size_t added = 0;
+		for (const bool b : {false, true})
+			copies[b].assign(count, none);
+		for (size_t k = 0; k < count; k++)
+		{
+			const bits::word_t* v = rows.data() + k * s;
+			for (const bool b : {false, true})
+			{
+				if (!buneman.present(c, b, c, b))
+					continue;
+				// the columns before c that conflict with state b of c
+				const bits::word_t* zero = buneman.implications(c, b);
+				const bits::word_t* one = zero + s;
+				bits::word_t x = 0;
+				for (size_t i = 0; i < word; i++)
+					x |= (zero[i] & v[i]) | (one[i] & ~v[i]);
+				x |= ((zero[word] & v[word]) | (one[word] & ~v[word])) & before;
+				if (x)
+					continue;
+				copies[b][k] = (uint32_t) added++;
+				next.insert(next.end(), v, v + s);
+				if (b)
+					bits::flip(next.data() + (next.size() - s), c);
+			}
+			if (copies[0][k] != none && copies[1][k] != none)
+				joined.push_back(E{copies[1][k], copies[0][k], (typename E::column_type) c});
+		}
+		for (const E& e : links)
+			for (const bool b : {false, true})
+				if (copies[b][e.u] != none && copies[b][e.v] != none)
+					joined.push_back(E{copies[b][e.u], copies[b][e.v], e.column});
+		rows.swap(next);
+		links.swap(joined);
+		joined.clear();
+		count = added;
+	}
+
+	// the terminals are in the store already
+	vector<vertex_type> id(count);
+	for (size_t k = 0; k < count; k++)
+	{
+		const bits::word_t* v = rows.data() + k * s;
+		const zobrist::fingerprint_t fp = zobrist::fingerprint<W>(v, s);
+		auto inserted = nodes.insert(v, fp, [this, v, fp] ()
+		{
+			return store.append(v, store.words(), fp);
+		});
+		id[k] = inserted.first;
+		if (inserted.second)
+			generated++;
+	}
+	for (const E& e : links)
+		edge.emplace_back(id[e.u], id[e.v], e.column);
+}
+
+template <class T, template <std::size_t> class I, class E>
+void BunemanGraph<T, I, E>::close (WorkStealingPool<vertex_type>& p, std::atomic<uint64_t>& generated)
+{
+	using namespace std;
+
+	// For binary characters the Buneman-Graph is the median closure of the
+	// terminals. Every round takes the medians of the triples with a vertex
+	// found in the round before, the triples of older vertices were all seen
+	// already. A vertex pairs only with the vertices before it in the list,
+	// so every triple is taken once, and the vertices of a round run in
+	// parallel while the list stays fixed.
+	vector<vertex_type> list(terminals);
+	for (vertex_type v = 0; v < terminals; v++)
+		list[v] = v;
+	vector<vector<vertex_type>> found(p.threads());
+	size_t known = 0;
+	while (known < list.size())
+	{
+		for (size_t k = known; k < list.size(); k++)
+			p.push((vertex_type) k);
+		p.run([this, &p, &list, &found, &generated] (const vertex_type k)
+		{
+			thread_local vector<bits::word_t> median;
+			thread_local taxon_type v1;
+			const size_t s = store.words();
+			median.resize(s);
+			const bits::word_t* c = store[list[k]];
+			for (size_t i = 0; i < k; i++)
+			{
+				const bits::word_t* a = store[list[i]];
+				for (size_t j = i + 1; j < k; j++)
+				{
+					const bits::word_t* b = store[list[j]];
+					for (size_t w = 0; w < bits::span<W>(s); w++)
+						median[w] = (a[w] & b[w]) | (a[w] & c[w]) | (b[w] & c[w]);
+					// a vertex between the other two needs no lookup
+					if (bits::equal<W>(median.data(), a, s) || bits::equal<W>(median.data(), b, s) || bits::equal<W>(median.data(), c, s))
+						continue;
+					v1.assign(median.data(), m);
+					auto inserted = nodes.insert(v1.data(), v1.hash(), [this] ()
+					{
+						return store.append(v1.data(), store.words(), v1.hash());
+					});
+					if (inserted.second)
+					{
+						found[p.worker()].push_back(inserted.first);
+						generated++;
+					}
+				}
+			}
+		});
+
+		known = list.size();
+		for (vector<vertex_type>& f : found)
+		{
+			list.insert(list.end(), f.begin(), f.end());
+			f.clear();
+		}
+	}
+}
+
+template <class T, template <std::size_t> class I, class E>
+std::size_t BunemanGraph<T, I, E>::parent (const bits::word_t* __restrict v, const std::vector<std::size_t>& distance, const std::size_t d, taxon_type& f, std::vector<bits::word_t>& toward) const
+{
+	const std::size_t s = store.words();
+	// columns in which v differs from one of its nearest terminals
+	toward.assign(s, 0);
+	for (vertex_type t = 0; t < terminals; t++)
+	{
+		if (distance[t] != d)
+			continue;
+		const bits::word_t* row = store[t];
+		for (std::size_t i = 0; i < s; i++)
+			toward[i] |= v[i] ^ row[i];
+	}
+
+	f.assign(v, m);
+	buneman.flips(v, f.data());
+	for (std::size_t i = 0; i < s; i++)
+	{
+		const bits::word_t x = toward[i] & f.data()[i];
+		if (x)
+			return i * bits::word_bits + bits::ctz(x);
+	}
+	return m;
+}
+
+template <class T, template <std::size_t> class I, class E>
+bool BunemanGraph<T, I, E>::propagate (bits::word_t* __restrict value, bits::word_t* __restrict fixed, const std::size_t j, const bool a, std::vector<std::size_t>& pending) const
+{
+	const std::size_t s = store.words();
+	if (bits::at(fixed, j))
+		return bits::at(value, j) == a;
+
+	bits::flip(fixed, j);
+	if (a)
+		bits::flip(value, j);
+	pending.clear();
+	pending.push_back(j);
+	while (!pending.empty())
+	{
+		const std::size_t l = pending.back();
+		pending.pop_back();
+		const bits::word_t* zero = buneman.implications(l, bits::at(value, l));
+		const bits::word_t* one = zero + s;
+		for (std::size_t i = 0; i < bits::span<W>(s); i++)
+		{
+			// forced into the state it is not fixed to, or into both states
+			if ((zero[i] & fixed[i] & value[i]) | (one[i] & fixed[i] & ~value[i]) | (zero[i] & one[i]))
+				return false;
+			bits::word_t x = (zero[i] | one[i]) & ~fixed[i];
+			fixed[i] |= x;
+			value[i] |= one[i] & x;
+			for (; x; x &= x - 1)
+				pending.push_back(i * bits::word_bits + bits::ctz(x));
+		}
+	}
+	return true;
+}
+
+template <class T, template <std::size_t> class I, class E>
+std::size_t BunemanGraph<T, I, E>::unfixed (const bits::word_t* __restrict fixed) const noexcept
+{
+	for (std::size_t i = 0; i < store.words(); i++)
+	{
+		const bits::word_t x = ~fixed[i] & (i + 1 == store.words() ? bits::tail(m) : ~bits::word_t(0));
+		if (x)
+			return i * bits::word_bits + bits::ctz(x);
+	}
+	return m;
+}
+
+template <class T, template <std::size_t> class I, class E>
+void BunemanGraph<T, I, E>::enumerate (WorkStealingPool<vertex_type>& p, std::atomic<uint64_t>& generated)
+{
+	using namespace std;
+
+	const size_t s = store.words();
+	// a partial assignment is the values followed by the mask of fixed characters
+	const size_t pitch = 2 * s;
+
+	const function<void (const bits::word_t*)> emit = [this, &generated] (const bits::word_t* value)
+	{
+		thread_local taxon_type v1;
+		v1.assign(value, m);
+		auto inserted = nodes.insert(v1.data(), v1.hash(), [this] ()
+		{
+			return store.append(v1.data(), store.words(), v1.hash());
+		});
+		if (inserted.second)
+			generated++;
+	};
+
+	// Branch breadth first until there is enough work for all threads. The
+	// input taxa satisfy the formula, and a 2-SAT formula that survives unit
+	// propagation stays satisfiable, so every branch ends in a solution.
+	vector<size_t> pending;
+	deque<vector<bits::word_t>> prefix;
+	prefix.emplace_back(pitch, 0);
+	while (!prefix.empty() && prefix.size() < 8 * p.threads())
+	{
+		vector<bits::word_t> state = move(prefix.front());
+		prefix.pop_front();
+		const size_t j = unfixed(state.data() + s);
+		if (j == m)
+		{
+			emit(state.data());
+			continue;
+		}
+		for (const bool a : {true, false})
+		{
+			vector<bits::word_t> next(state);
+			if (propagate(next.data(), next.data() + s, j, a, pending))
+				prefix.push_back(move(next));
+		}
+	}
+	vector<vector<bits::word_t>> work;
+	for (auto& state : prefix)
+		work.push_back(move(state));
+	prefix.clear();
+
+	for (vertex_type i = 0; i < work.size(); i++)
+		p.push(i);
+
+	// depth first below every prefix, one partial assignment per level
+	p.run([this, &work, &emit, s, pitch] (const vertex_type w)
+	{
+		thread_local vector<bits::word_t> stack;
+		thread_local vector<size_t> propagation;
+		// character branched on and the next state to try on every level
+		thread_local vector<pair<size_t, int>> branch;
+
+		stack.assign((m + 2) * pitch, 0);
+		copy(work[w].begin(), work[w].end(), stack.begin());
+		branch.clear();
+
+		// the state of level d is followed by the state of its branch on level d + 1
+		size_t level = 0;
+		bool descend = true;
+		while (true)
+		{
+			if (descend)
+			{
+				const bits::word_t* state = stack.data() + level * pitch;
+				const size_t j = unfixed(state + s);
+				if (j == m)
+					emit(state);
+				else
+					branch.emplace_back(j, 0);
+			}
+			descend = false;
+			if (branch.empty())
+				break;
+
+			pair<size_t, int>& b = branch.back();
+			if (b.second == 2)
+			{
+				branch.pop_back();
+				continue;
+			}
+			const bool a = b.second++ == 0;
+			const size_t parent = branch.size() - 1;
+			bits::word_t* next = stack.data() + (parent + 1) * pitch;
+			copy(stack.data() + parent * pitch, next, next);
+			if (propagate(next, next + s, b.first, a, propagation))
+			{
+				level = parent + 1;
+				descend = true;
+			}
+		}
+	});
+}
+
+template <class T, template <std::size_t> class I, class E>
+void BunemanGraph<T, I, E>::connect ()
+{
+	using namespace std;
+
+	order.clear();
+	order.reserve(nodes.size());
+	nodes.for_each([this] (const vertex_type v)
+	{
+		order.push_back(v);
+	});
+	if (!node_set::ordered)
+		sort(order.begin(), order.end(), less{&store});
+	index.assign(store.size(), 0);
+	for (size_t i = 0; i < order.size(); i++)
+		index[order[i]] = i + 1;
+	// the edges are already known, unless an engine without expansion ran
+	if (options.connect == Options::Connect::fused && options.generator == Options::Generator::bfs)
+		return;
+	if (options.generator == Options::Generator::split)
+		return;
+	uint64_t vertices = order.size() + 1;
+	atomic<uint64_t> counter(0);
+	shared_mutex edges_lock;
+	mutex output;
+	condition_variable output_monitor;
+	bool end = false;
+
+	const auto progress = [this, &end, &counter, &output, &vertices, &edges_lock, &output_monitor] ()
+	{
+		uint64_t last_e = 0;
+		uint64_t last_v = 0;
+		uint64_t e;
+		double idx = vertices - 1;
+		while (true)
+		{
+			unique_lock<decltype(output)> lock(output);
+			output_monitor.wait_for(lock, OUTPUT_TIMEOUT, [&end] () { return end; });
+			if (is_terminal())
+				goto_beginning_of_line();
+			{
+				shared_lock<decltype(edges_lock)> lock_e(edges_lock);
+				e = edge.size();
+			}
+			printf("%10" PRIu64 ": %6.2lf%%  E/s: %5" PRIu64 "   V/s: %5" PRIu64,
+				e,
+				(counter / idx) * 100,
+				(e-last_e) * OUTPUT_MULTIPLIER,
+				(counter-last_v) * OUTPUT_MULTIPLIER
+			);
+			last_e = e;
+			last_v = counter;
+			if (is_terminal())
+				fflush(stdout);
+			else
+				printf("\n");
+
+			if (end)
+				break;
+		}
+	};
+	thread output_thread;
+	if (options.progress)
+		output_thread = thread(progress);
+
+	ThreadPool p(options.workers());
+	if (options.connect == Options::Connect::scan)
+	{
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			p.enqueue<void>([this, &edges_lock, i, &counter] ()
+			{
+				const bits::word_t* v = store[order[i]];
+				for (size_t l = i + 1; l < order.size(); l++)
+				{
+					const bits::word_t* u = store[order[l]];
+					if (bits::distance<W>(v, u, store.words()) == 1)
+					{
+						size_t d = bits::difference<W>(v, u, store.words());
+						{
+							unique_lock<decltype(edges_lock)> lock(edges_lock);
+							edge.emplace_back(order[i], order[l], d);
+						}
+					}
+				}
+
+				counter++;
+
+			});
+		}
+	}
+	else
+	{
+		// every vertex costs the same m lookups, so equal ranges are balanced
+		const size_t tasks = 8 * options.workers();
+		const size_t range = (order.size() + tasks - 1) / tasks;
+		for (size_t from = 0; from < order.size(); from += range)
+		{
+			const size_t to = min(from + range, order.size());
+			p.enqueue<void>([this, &edges_lock, from, to, &counter] ()
+			{
+				thread_local taxon_type v1;
+				edge_list found;
+				for (size_t i = from; i < to; i++)
+				{
+					v1.assign(store[order[i]], m);
+					// setting a bit gives the smaller taxon, so every edge is found once
+					for (size_t j = 0; j < m; j++)
+					{
+						if (v1[j])
+							continue;
+						v1.flip(j);
+						const vertex_type u = nodes.find(v1.data(), v1.hash());
+						if (u != store_type::none)
+							found.emplace_back(u, order[i], j);
+						v1.flip(j);
+					}
+					counter++;
+				}
+				unique_lock<decltype(edges_lock)> lock(edges_lock);
+				edge.splice(found);
+			});
+		}
+	}
+
+	p.shutdown();
+	{
+		unique_lock<decltype(output)> lock(output);
+		end = true;
+		output_monitor.notify_one();
+	}
+	if (!options.progress)
+		return;
+	output_thread.join();
+	printf("\n");
+}
+
+template <class T, template <std::size_t> class I, class E>
+void BunemanGraph<T, I, E>::write_edges (FILE* __restrict fp) const
+{
+	edge.for_each([this, fp] (const E& e)
+	{
+		fprintf(fp, "E %" PRIu64 " %" PRIu64 " %" PRIu64 "\n", index[e.u], index[e.v], weight[e.column]);
+	});
+}
+
+template <class T, template <std::size_t> class I, class E>
+void BunemanGraph<T, I, E>::write_terminals (FILE* __restrict fp) const
+{
+	for (size_t i = 0; i < order.size(); i++)
+		if (order[i] < terminals)
+			fprintf(fp, "T %zu\n", i + 1);
+}
+
+template <class T, template <std::size_t> class I, class E>
+void BunemanGraph<T, I, E>::write_vertices (FILE* __restrict fp) const
+{
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const bits::word_t* v = store[order[i]];
+		fprintf(fp, "%zu\t", i + 1);
+		for (size_t j = 0; j < m; j++)
+			fputc(bits::at(v, j) ? '1' : '0', fp);
+		fprintf(fp, (order[i] < terminals ? "\tterminal" : ""));
+		fputc('\n', fp);
+	}
+}
+
+#endif /* BUNEMANGRAPH_HPP_ */
@@ -0,0 +1,54 @@
+/**
+ * \file
+ * \brief Progress output on the console
+ *
+ * \date 2026-10-17
+ */
+
+#include "def.hpp"
+#include "Console.hpp"
+
+#include <cstdio>
+
+#if __unix__
+#include <unistd.h>
+#elif _WIN32
+#include <Windows.h>
+#endif
+
+static int __terminal = -1;
+
+#if _WIN32
+static HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+#endif
+
+bool is_terminal()
+{
+	if (__terminal < 0) {
+#if __unix__
+		if (isatty(STDOUT_FILENO))
+			__terminal = 1;
+		else
+			__terminal = 0;
+#elif _WIN32
+		if (GetFileType(hConsole) == FILE_TYPE_CHAR)
+			__terminal = 1;
+		else
+			__terminal = 0;
+#endif
+	}
+	return (bool) __terminal;
+}
+
+void goto_beginning_of_line()
+{
+#if __unix__
+	printf("\033[G");
+#elif _WIN32
+	CONSOLE_SCREEN_BUFFER_INFO pBufferInfo;
+	GetConsoleScreenBufferInfo(hConsole, &pBufferInfo);
+	COORD pos = pBufferInfo.dwCursorPosition;
+	pos.X = 0;
+	SetConsoleCursorPosition(hConsole, pos);
+#endif
+}
@@ -0,0 +1,23 @@
+/**
+ * \file
+ * \brief Progress output on the console
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef CONSOLE_HPP_
+#define CONSOLE_HPP_
+
+#include "def.hpp"
+#include <chrono>
+
+#define OUTPUT_TIMEOUT std::chrono::milliseconds(250)
+#define OUTPUT_MULTIPLIER 4
+
+/// true if stdout is an interactive console
+bool is_terminal();
+
+/// move the cursor back to the start of the current line
+void goto_beginning_of_line();
+
+#endif /* CONSOLE_HPP_ */
@@ -0,0 +1,115 @@
+/**
+ * \file
+ * \brief Compact storage for the edges of the Buneman-Graph
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef EDGEBUFFER_HPP_
+#define EDGEBUFFER_HPP_
+
+#include "def.hpp"
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Edge between the vertices u and v, which differ in one column. The weight
+ * is looked up from the column when the edge is written.
+ */
+template <class C>
+struct BasicEdge
+{
+	typedef C column_type;
+
+	uint32_t u;
+	uint32_t v;
+	C column;
+};
+
+/// edge of a graph with at most EDGE_MAX_COLUMNS columns
+typedef BasicEdge<uint16_t> Edge;
+/// edge of a graph with any number of columns
+typedef BasicEdge<uint64_t> WideEdge;
+
+/// largest number of columns an Edge can refer to
+static constexpr std::size_t EDGE_MAX_COLUMNS = std::size_t(UINT16_MAX) + 1;
+
+/**
+ * Append only list of edges in chunks. Growing never copies, and
+ * the chunks of a buffer filled by one thread can be moved into another
+ * buffer in O(chunks), so every thread collects into its own buffer and the
+ * buffers are merged at the end without touching the edges.
+ *
+ * The chunks grow with the buffer up to a fixed size, so the many small
+ * buffers of short tasks stay small.
+ *
+ * A buffer is not thread safe, each thread needs its own.
+ */
+template <class E = Edge>
+class EdgeBuffer
+{
+public:
+	EdgeBuffer () :
+			count(0)
+	{
+	}
+
+	EdgeBuffer (EdgeBuffer&&) = default;
+	EdgeBuffer& operator= (EdgeBuffer&&) = default;
+
+	void emplace_back (const uint32_t u, const uint32_t v, const std::size_t column)
+	{
+		if (chunks.empty() || chunks.back().size == chunks.back().capacity)
+		{
+			const std::size_t capacity = count < min_chunk ? min_chunk : (count < max_chunk ? count : max_chunk);
+			chunks.push_back(chunk{std::unique_ptr<E[]>(new E[capacity]), 0, capacity});
+		}
+		chunk& c = chunks.back();
+		c.edges[c.size++] = E{u, v, (typename E::column_type) column};
+		count++;
+	}
+
+	/// move all edges of other to the end of this buffer
+	void splice (EdgeBuffer& other)
+	{
+		for (chunk& c : other.chunks)
+			chunks.push_back(std::move(c));
+		count += other.count;
+		other.chunks.clear();
+		other.count = 0;
+	}
+
+	std::size_t size () const noexcept
+	{
+		return count;
+	}
+
+	/// call f for every edge
+	template <class F>
+	void for_each (F f) const
+	{
+		for (const chunk& c : chunks)
+			for (std::size_t i = 0; i < c.size; i++)
+				f(c.edges[i]);
+	}
+
+private:
+	/// edges in the first and in the largest chunks
+	static constexpr std::size_t min_chunk = 64;
+	static constexpr std::size_t max_chunk = 1 << 14;
+
+	struct chunk
+	{
+		std::unique_ptr<E[]> edges;
+		std::size_t size;
+		std::size_t capacity;
+	};
+
+	std::vector<chunk> chunks;
+	std::size_t count;
+};
+
+#endif /* EDGEBUFFER_HPP_ */
@@ -0,0 +1,128 @@
+/**
+ * \file
+ * \brief Taxon with a length fixed at compile time
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef FIXEDTAXON_HPP_
+#define FIXEDTAXON_HPP_
+
+#include "def.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "Bits.hpp"
+#include "Zobrist.hpp"
+#include "Taxon.hpp"
+
+/**
+ * Value type counterpart of Taxon for at most W * 64 characters. The bits are
+ * stored inline, so copying does not allocate and all loops over the words are
+ * unrolled by the compiler.
+ */
+template <std::size_t W>
+class FixedTaxon
+{
+public:
+	static constexpr std::size_t Words = W;
+
+	FixedTaxon () noexcept :
+			Terminal(false),
+			fingerprint(0),
+			internal()
+	{
+	}
+
+	explicit FixedTaxon (const Taxon& other) :
+			Terminal(other.Terminal),
+			fingerprint(other.hash()),
+			internal()
+	{
+		if (other.words() > W)
+		{
+			throw std::logic_error("Taxon does not fit into fixed width");
+		}
+		for (std::size_t i = 0; i < other.words(); i++)
+			internal[i] = other.data()[i];
+	}
+
+	/// copy the first W words of a packed bit string
+	FixedTaxon (const bits::word_t* __restrict src, const std::size_t) noexcept :
+			Terminal(false)
+	{
+		assign(src, W);
+	}
+
+	/// overwrite with the first W words of a packed bit string
+	void assign (const bits::word_t* __restrict src, const std::size_t) noexcept
+	{
+		for (std::size_t i = 0; i < W; i++)
+			internal[i] = src[i];
+		fingerprint = zobrist::fingerprint<W>(internal.data());
+	}
+
+	bool operator[] (std::size_t pos) const noexcept
+	{
+		return bits::at(internal.data(), pos);
+	}
+
+	bool at (std::size_t pos) const noexcept
+	{
+		return bits::at(internal.data(), pos);
+	}
+
+	void flip (const std::size_t pos) noexcept
+	{
+		bits::flip(internal.data(), pos);
+		fingerprint ^= zobrist::key(pos);
+	}
+
+	bool operator== (const FixedTaxon& other) const noexcept
+	{
+		return bits::equal<W>(internal.data(), other.internal.data());
+	}
+
+	bool operator< (const FixedTaxon& other) const noexcept
+	{
+		return bits::less<W>(internal.data(), other.internal.data());
+	}
+
+	/// get hamming distance
+	std::size_t distance (const FixedTaxon& other) const noexcept
+	{
+		return bits::distance<W>(internal.data(), other.internal.data());
+	}
+
+	/// get first occurance of diverging bit
+	std::size_t difference (const FixedTaxon& other) const noexcept
+	{
+		return bits::difference<W>(internal.data(), other.internal.data());
+	}
+
+	/// Zobrist fingerprint, kept up to date by flip
+	std::size_t hash () const noexcept
+	{
+		return (std::size_t) fingerprint;
+	}
+
+	const bits::word_t* data () const noexcept
+	{
+		return internal.data();
+	}
+
+	bits::word_t* data () noexcept
+	{
+		return internal.data();
+	}
+
+	bool Terminal;
+
+private:
+	zobrist::fingerprint_t fingerprint;
+	std::array<bits::word_t, W> internal;
+};
+
+#endif /* FIXEDTAXON_HPP_ */
@@ -0,0 +1,39 @@
+/**
+ * \file
+ * \brief Interface of the generated graphs
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef GRAPH_HPP_
+#define GRAPH_HPP_
+
+#include "def.hpp"
+#include <cstdio>
+#include <cstddef>
+
+/// Interface of the Buneman-Graph, independent of the taxon representation
+class Graph
+{
+public:
+	virtual ~Graph () {}
+
+	/// generate the Buneman-Graph
+	virtual void generate () = 0;
+	/// Generate the edges
+	virtual void connect () = 0;
+
+	/// number of vertices
+	virtual std::size_t vertices () const = 0;
+	/// number of edges
+	virtual std::size_t edges () const = 0;
+
+	/// write the edges in stp format
+	virtual void write_edges (FILE* __restrict) const = 0;
+	/// write the terminals in stp format
+	virtual void write_terminals (FILE* __restrict) const = 0;
+	/// write the vertices with their index
+	virtual void write_vertices (FILE* __restrict) const = 0;
+};
+
+#endif /* GRAPH_HPP_ */
@@ -0,0 +1,173 @@
+/**
+ * \file
+ * \brief Concurrent membership index for the vertices of the Buneman-Graph
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef NODEINDEX_HPP_
+#define NODEINDEX_HPP_
+
+#include "def.hpp"
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+#include "Bits.hpp"
+#include "Zobrist.hpp"
+#include "TaxonStore.hpp"
+
+/**
+ * Hash index of the vertices in a TaxonStore, sharded by the Zobrist
+ * fingerprint. Each shard is an open addressing table with linear probing,
+ * protected by its own lock, so threads only contend if their taxa fall
+ * into the same shard.
+ *
+ * The index has no order, iteration is meant for the single threaded
+ * phases after generation.
+ */
+template <std::size_t W>
+class NodeIndex
+{
+public:
+	typedef TaxonStore<W> store_type;
+	typedef typename store_type::id_type vertex_type;
+
+	/// for_each visits the vertices in no particular order
+	static constexpr bool ordered = false;
+
+	/// shards = 2^shard_bits, at most 2^32
+	NodeIndex (const store_type& store, const std::size_t shard_bits = 10) :
+			store(store),
+			shift(bits::word_bits - shard_bits),
+			shards(new shard[std::size_t(1) << shard_bits]),
+			count(0),
+			shard_count(std::size_t(1) << shard_bits)
+	{
+	}
+
+	NodeIndex (const NodeIndex&) = delete;
+	NodeIndex& operator= (const NodeIndex&) = delete;
+
+	/// id of the vertex with the given bits, or store_type::none
+	vertex_type find (const bits::word_t* __restrict row, const zobrist::fingerprint_t fp) const
+	{
+		const shard& s = select(fp);
+		std::unique_lock<std::mutex> lock(s.mx);
+		return s.table.empty() ? store_type::none : s.table[lookup(s, row, fp)].id;
+	}
+
+	/**
+	 * Insert the taxon if it is absent. create() is called under the lock of
+	 * the shard to store the taxon and has to return its id. Returns the id of
+	 * the vertex and whether it was inserted.
+	 */
+	template <class F>
+	std::pair<vertex_type, bool> insert (const bits::word_t* __restrict row, const zobrist::fingerprint_t fp, F create)
+	{
+		shard& s = select(fp);
+		std::unique_lock<std::mutex> lock(s.mx);
+		if ((s.size + 1) * 4 > s.table.size() * 3)
+			grow(s);
+
+		entry& e = s.table[lookup(s, row, fp)];
+		if (e.id != store_type::none)
+			return std::make_pair(e.id, false);
+
+		e.id = create();
+		e.tag = tag(fp);
+		s.size++;
+		count++;
+		return std::make_pair(e.id, true);
+	}
+
+	/// number of vertices in the index
+	std::size_t size () const noexcept
+	{
+		return count.load();
+	}
+
+	/// call f for every vertex, must not run concurrently with insert
+	template <class F>
+	void for_each (F f) const
+	{
+		for (std::size_t i = 0; i < shard_count; i++)
+			for (const entry& e : shards[i].table)
+				if (e.id != store_type::none)
+					f(e.id);
+	}
+
+private:
+	struct entry
+	{
+		vertex_type id;
+		/// fingerprint bits not used for the position, to skip most row compares
+		uint32_t tag;
+	};
+
+	struct shard
+	{
+		mutable std::mutex mx;
+		std::vector<entry> table;
+		std::size_t size = 0;
+	};
+
+	const store_type& store;
+	const std::size_t shift;
+	std::unique_ptr<shard[]> shards;
+	std::atomic<std::size_t> count;
+	const std::size_t shard_count;
+
+	/**
+	 * The 32 bits right below the ones that select the shard. They only
+	 * reach down into the bits of the slot once the shards together have
+	 * more than 2^32 slots, and then the tag merely filters less.
+	 */
+	uint32_t tag (const zobrist::fingerprint_t fp) const noexcept
+	{
+		return (uint32_t) (fp >> (shift - 32));
+	}
+
+	shard& select (const zobrist::fingerprint_t fp) const noexcept
+	{
+		return shards[shard_count > 1 ? fp >> shift : 0];
+	}
+
+	/// slot holding the taxon, or the empty slot it belongs into
+	std::size_t lookup (const shard& s, const bits::word_t* __restrict row, const zobrist::fingerprint_t fp) const noexcept
+	{
+		const std::size_t mask = s.table.size() - 1;
+		const uint32_t t = tag(fp);
+		for (std::size_t i = fp & mask; ; i = (i + 1) & mask)
+		{
+			const entry& e = s.table[i];
+			if (e.id == store_type::none)
+				return i;
+			if (e.tag == t && bits::equal<W>(store[e.id], row, store.words()))
+				return i;
+		}
+	}
+
+	/// double the table of a shard
+	void grow (shard& s)
+	{
+		std::vector<entry> old(s.table.empty() ? 8 : s.table.size() * 2, entry{store_type::none, 0});
+		old.swap(s.table);
+		const std::size_t mask = s.table.size() - 1;
+		for (const entry& e : old)
+		{
+			if (e.id == store_type::none)
+				continue;
+			std::size_t i = store.fingerprint(e.id) & mask;
+			while (s.table[i].id != store_type::none)
+				i = (i + 1) & mask;
+			s.table[i] = e;
+		}
+	}
+};
+
+#endif /* NODEINDEX_HPP_ */
@@ -0,0 +1,76 @@
+/**
+ * \file
+ * \brief Settings from the command line
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef OPTIONS_HPP_
+#define OPTIONS_HPP_
+
+#include "def.hpp"
+#include <cstddef>
+#include <thread>
+
+/// Settings from the command line
+struct Options
+{
+	/// Data structure for the vertex set
+	enum class Index
+	{
+		/// sharded hash table, sorted once before connecting
+		hash,
+		/// concurrent B-tree, kept sorted during generation
+		btree
+	};
+
+	/// Edge discovery after generation
+	enum class Connect
+	{
+		/// compare every pair of vertices, O(V^2)
+		scan,
+		/// look up the m neighbours of every vertex in the index, O(V m)
+		probe,
+		/// record the edges while generating, no separate pass
+		fused
+	};
+
+	/// Enumeration of the vertices of the Buneman-Graph
+	enum class Generator
+	{
+		/// breadth first search over single bit flips from the terminals
+		bfs,
+		/// enumerate the solutions of the 2-SAT formula of the Buneman condition
+		sat,
+		/// reverse search, every vertex is only expanded from its canonical parent
+		reverse,
+		/// zero-suppressed decision diagram, the vertices are never stored
+		zdd,
+		/// add one column at a time and split the vertices it conflicts with
+		split,
+		/// median closure of the terminals, O(V^3) medians for sparse inputs
+		median
+	};
+
+	Index index = Index::hash;
+	Connect connect = Connect::probe;
+	Generator generator = Generator::bfs;
+	/// remove columns that separate a single taxon, their edges are pendant
+	bool singletons = false;
+	/// solve the components of the incompatibility graph of the columns separately
+	bool decompose = false;
+	/// print progress and counts while building the graph
+	bool progress = true;
+	/// workers of every pool, 0 for one per hardware thread
+	std::size_t threads = 0;
+
+	/// number of workers a pool should start
+	std::size_t workers () const noexcept
+	{
+		if (threads)
+			return threads;
+		return std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+	}
+};
+
+#endif /* OPTIONS_HPP_ */
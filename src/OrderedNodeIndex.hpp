@@ -0,0 +1,110 @@
+/**
+ * \file
+ * \brief Ordered concurrent membership index for the vertices of the Buneman-Graph
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef ORDEREDNODEINDEX_HPP_
+#define ORDEREDNODEINDEX_HPP_
+
+#include "def.hpp"
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+#include "btree/concurrent_btree_set.h"
+
+#include "Bits.hpp"
+#include "Zobrist.hpp"
+#include "TaxonStore.hpp"
+
+/**
+ * Index of the vertices in a TaxonStore, kept in the output order in a
+ * concurrent B-tree of vertex ids. Lookups do not lock at all, inserts only
+ * lock the leaf they change. Same interface as NodeIndex, but for_each visits
+ * the vertices sorted, so connect does not have to sort them.
+ */
+template <std::size_t W>
+class OrderedNodeIndex
+{
+public:
+	typedef TaxonStore<W> store_type;
+	typedef typename store_type::id_type vertex_type;
+
+	/// for_each visits the vertices in their output order
+	static constexpr bool ordered = true;
+
+	OrderedNodeIndex (const store_type& store) :
+			store(store),
+			tree(less{&store})
+	{
+	}
+
+	OrderedNodeIndex (const OrderedNodeIndex&) = delete;
+	OrderedNodeIndex& operator= (const OrderedNodeIndex&) = delete;
+
+	/// id of the vertex with the given bits, or store_type::none
+	vertex_type find (const bits::word_t* __restrict row, const zobrist::fingerprint_t) const
+	{
+		vertex_type id;
+		return tree.find(probe{row}, &id) ? id : store_type::none;
+	}
+
+	/**
+	 * Insert the taxon if it is absent. create() is called under the lock of
+	 * the leaf to store the taxon and has to return its id. Returns the id of
+	 * the vertex and whether it was inserted.
+	 */
+	template <class F>
+	std::pair<vertex_type, bool> insert (const bits::word_t* __restrict row, const zobrist::fingerprint_t, F create)
+	{
+		return tree.insert(probe{row}, create);
+	}
+
+	/// number of vertices in the index
+	std::size_t size () const noexcept
+	{
+		return tree.size();
+	}
+
+	/// call f for every vertex in order, must not run concurrently with insert
+	template <class F>
+	void for_each (F f) const
+	{
+		tree.for_each(f);
+	}
+
+private:
+	/// bits of a taxon that is not stored yet
+	struct probe
+	{
+		const bits::word_t* row;
+	};
+
+	/// order of the output, on stored vertices and probes
+	struct less
+	{
+		const store_type* store;
+
+		bool operator() (const vertex_type lhs, const vertex_type rhs) const noexcept
+		{
+			return bits::less<W>((*store)[lhs], (*store)[rhs], store->words());
+		}
+
+		bool operator() (const vertex_type lhs, const probe& rhs) const noexcept
+		{
+			return bits::less<W>((*store)[lhs], rhs.row, store->words());
+		}
+
+		bool operator() (const probe& lhs, const vertex_type rhs) const noexcept
+		{
+			return bits::less<W>(lhs.row, (*store)[rhs], store->words());
+		}
+	};
+
+	const store_type& store;
+	btree::concurrent_btree_set<vertex_type, less> tree;
+};
+
+#endif /* ORDEREDNODEINDEX_HPP_ */
@@ -0,0 +1,157 @@
+/**
+ * \file
+ * \brief
+ *
+ * \date 2026-10-17
+ */
+
+#include "def.hpp"
+#include "PerfectPhylogeny.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include <inttypes.h>
+
+using namespace std;
+
+PerfectPhylogeny::PerfectPhylogeny (const uint64_t m, const vector<uint64_t>& weight) :
+			m(m),
+			weight(weight)
+{
+}
+
+PerfectPhylogeny::~PerfectPhylogeny ()
+{
+}
+
+bool PerfectPhylogeny::build (const vector<Taxon>& taxa)
+{
+	if (taxa.empty())
+		return false;
+	const Taxon& root = taxa[0];
+
+	// size of the cluster of every column
+	vector<size_t> size(m, 0);
+	for (const Taxon& t : taxa)
+		for (size_t j = 0; j < m; j++)
+			if (t[j] != root[j])
+				size[j]++;
+
+	vector<size_t> sorted(m);
+	for (size_t j = 0; j < m; j++)
+	{
+		// a constant column has no edge
+		if (size[j] == 0)
+			return false;
+		sorted[j] = j;
+	}
+	stable_sort(sorted.begin(), sorted.end(), [&size] (const size_t a, const size_t b)
+	{
+		return size[a] > size[b];
+	});
+
+	// parent column of every column, m for the root
+	const size_t unset = numeric_limits<size_t>::max();
+	vector<size_t> parent(m, unset);
+	vector<size_t> below(taxa.size(), m);
+	for (size_t i = 0; i < taxa.size(); i++)
+	{
+		size_t previous = m;
+		for (size_t j : sorted)
+		{
+			if (taxa[i][j] == root[j])
+				continue;
+			if (parent[j] == unset)
+				parent[j] = previous;
+			else if (parent[j] != previous)
+				return false;
+			previous = j;
+		}
+		below[i] = previous;
+	}
+
+	// parents come first in sorted, so each vertex flips one column of its parent
+	vertex.assign(m + 1, Taxon());
+	vertex[0] = root;
+	for (size_t j : sorted)
+	{
+		const size_t p = parent[j] == m ? 0 : parent[j] + 1;
+		vertex[j + 1] = vertex[p];
+		vertex[j + 1].flip(j);
+	}
+
+	terminal.assign(m + 1, false);
+	for (size_t i = 0; i < taxa.size(); i++)
+		terminal[below[i] == m ? 0 : below[i] + 1] = true;
+
+	order.resize(m + 1);
+	for (size_t v = 0; v <= m; v++)
+		order[v] = (uint32_t) v;
+	sort(order.begin(), order.end(), [this] (const uint32_t a, const uint32_t b)
+	{
+		return vertex[a] < vertex[b];
+	});
+	index.assign(m + 1, 0);
+	for (size_t i = 0; i <= m; i++)
+		index[order[i]] = i + 1;
+
+	// the endpoint with the bit set comes first, as in the Buneman-Graph
+	edge.clear();
+	edge.reserve(m);
+	for (size_t j = 0; j < m; j++)
+	{
+		const uint32_t u = (uint32_t) (j + 1);
+		const uint32_t p = (uint32_t) (parent[j] == m ? 0 : parent[j] + 1);
+		if (vertex[u][j])
+			edge.push_back(WideEdge{u, p, j});
+		else
+			edge.push_back(WideEdge{p, u, j});
+	}
+	return true;
+}
+
+void PerfectPhylogeny::generate ()
+{
+}
+
+void PerfectPhylogeny::connect ()
+{
+}
+
+size_t PerfectPhylogeny::vertices () const
+{
+	return vertex.size();
+}
+
+size_t PerfectPhylogeny::edges () const
+{
+	return edge.size();
+}
+
+void PerfectPhylogeny::write_edges (FILE* __restrict fp) const
+{
+	for (const WideEdge& e : edge)
+		fprintf(fp, "E %" PRIu64 " %" PRIu64 " %" PRIu64 "\n", index[e.u], index[e.v], weight[e.column]);
+}
+
+void PerfectPhylogeny::write_terminals (FILE* __restrict fp) const
+{
+	for (size_t i = 0; i < order.size(); i++)
+		if (terminal[order[i]])
+			fprintf(fp, "T %zu\n", i + 1);
+}
+
+void PerfectPhylogeny::write_vertices (FILE* __restrict fp) const
+{
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const Taxon& v = vertex[order[i]];
+		fprintf(fp, "%zu\t", i + 1);
+		for (size_t j = 0; j < m; j++)
+			fputc(v[j] ? '1' : '0', fp);
+		fprintf(fp, (terminal[order[i]] ? "\tterminal" : ""));
+		fputc('\n', fp);
+	}
+}
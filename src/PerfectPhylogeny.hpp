@@ -0,0 +1,69 @@
+/**
+ * \file
+ * \brief Buneman-Graph of a matrix with a perfect phylogeny
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef PERFECTPHYLOGENY_HPP_
+#define PERFECTPHYLOGENY_HPP_
+
+#include "def.hpp"
+#include <cstdio>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "Graph.hpp"
+#include "Taxon.hpp"
+#include "EdgeBuffer.hpp"
+
+/**
+ * If all columns are pairwise compatible, the Buneman-Graph is a tree with
+ * one edge per column, and it is the optimal Steiner tree. It is built
+ * directly with Gusfield's algorithm: seen from the first taxon, the taxa
+ * that differ in a column form a cluster, and the clusters of compatible
+ * columns are nested or disjoint. Sorted by size, the parent of a column is
+ * the column before it in the list of every taxon of its cluster. If some
+ * column gets two different parents, the columns are not compatible.
+ */
+class PerfectPhylogeny : public Graph
+{
+public:
+	PerfectPhylogeny (const uint64_t m, const std::vector<uint64_t>& weight);
+	virtual ~PerfectPhylogeny ();
+
+	/// build the tree of the taxa, false if they have no perfect phylogeny
+	bool build (const std::vector<Taxon>&);
+
+	/// the tree is complete after build
+	void generate ();
+	/// the edges are known after build
+	void connect ();
+
+	std::size_t vertices () const;
+	std::size_t edges () const;
+
+	void write_edges (FILE* __restrict) const;
+	void write_terminals (FILE* __restrict) const;
+	void write_vertices (FILE* __restrict) const;
+
+private:
+	/// Length of each Taxon
+	uint64_t m;
+
+	std::vector<uint64_t> weight;
+
+	/// vertex 0 is the first taxon, vertex j + 1 is below the edge of column j
+	std::vector<Taxon> vertex;
+	std::vector<bool> terminal;
+	/// only m edges, so they can refer to any column
+	std::vector<WideEdge> edge;
+
+	/// vertices in the order of their index
+	std::vector<uint32_t> order;
+	/// index of each vertex
+	std::vector<uint64_t> index;
+};
+
+#endif /* PERFECTPHYLOGENY_HPP_ */
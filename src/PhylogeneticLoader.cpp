@@ -21,68 +21,36 @@
 #include <mutex>
 #include <atomic>
 #include <thread>
+#include <future>
 #include <limits>
 #include <chrono>
 #include <condition_variable>
 #include <shared_mutex>
+#include <unordered_map>
+#include <functional>
 
 #include <inttypes.h>
 
 #include <experimental/filesystem>
 
-#include "btree/btree_set.h"
+#include <boost/functional/hash.hpp>
 
 #include "Taxon.hpp"
+#include "FixedTaxon.hpp"
+#include "PerfectPhylogeny.hpp"
+#include "BunemanDiagram.hpp"
 #include "ThreadPool.hpp"
+#include "BunemanGraph.hpp"
 
-#if __unix__
-#include <unistd.h>
-#elif _WIN32
+#if _WIN32
 #include <Windows.h>
 #endif
 
-#define OUTPUT_TIMEOUT std::chrono::milliseconds(250)
-#define OUTPUT_MULTIPLIER 4
-
 using namespace std;
 namespace fs = std::experimental::filesystem;
 
-static int __terminal = -1;
-
-#if _WIN32
-static HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-#endif
-
-static inline bool is_terminal()
-{
-	if (__terminal < 0) {
-#if __unix__
-		if (isatty(STDOUT_FILENO))
-			__terminal = 1;
-		else
-			__terminal = 0;
-#elif _WIN32
-		if (GetFileType(hConsole) == FILE_TYPE_CHAR)
-			__terminal = 1;
-		else
-			__terminal = 0;
-#endif
-	}
-	return (bool) __terminal;
-}
-
-static inline void goto_beginning_of_line()
-{
-#if __unix__
-	printf("\033[G");
-#elif _WIN32
-	CONSOLE_SCREEN_BUFFER_INFO pBufferInfo;
-	GetConsoleScreenBufferInfo(hConsole, &pBufferInfo);
-	COORD pos = pBufferInfo.dwCursorPosition;
-	pos.X = 0;
-	SetConsoleCursorPosition(hConsole, pos);
-#endif
-}
+/// parts of a decomposed input with at most this many columns are generated on one thread
+static constexpr size_t SMALL_PART_COLUMNS = 16;
 
 int main (int argc, char* argv[])
 {
@@ -90,17 +58,84 @@ int main (int argc, char* argv[])
 	SetConsoleOutputCP(CP_UTF8);
 #endif
 
-	if (argc != 2)
+	Options options;
+	const char* input = nullptr;
+	for (int i = 1; i < argc; i++)
+	{
+		string arg(argv[i]);
+		if (arg == "-i" && i + 1 < argc)
+		{
+			string value(argv[++i]);
+			if (value == "hash")
+				options.index = Options::Index::hash;
+			else if (value == "btree")
+				options.index = Options::Index::btree;
+			else
+			{
+				printf("Unknown index: %s\n", value.c_str());
+				return 1;
+			}
+		}
+		else if (arg == "-c" && i + 1 < argc)
+		{
+			string value(argv[++i]);
+			if (value == "scan")
+				options.connect = Options::Connect::scan;
+			else if (value == "probe")
+				options.connect = Options::Connect::probe;
+			else if (value == "fused")
+				options.connect = Options::Connect::fused;
+			else
+			{
+				printf("Unknown connect method: %s\n", value.c_str());
+				return 1;
+			}
+		}
+		else if (arg == "-g" && i + 1 < argc)
+		{
+			string value(argv[++i]);
+			if (value == "bfs")
+				options.generator = Options::Generator::bfs;
+			else if (value == "2sat")
+				options.generator = Options::Generator::sat;
+			else if (value == "reverse")
+				options.generator = Options::Generator::reverse;
+			else if (value == "zdd")
+				options.generator = Options::Generator::zdd;
+			else if (value == "split")
+				options.generator = Options::Generator::split;
+			else if (value == "median")
+				options.generator = Options::Generator::median;
+			else
+			{
+				printf("Unknown generator: %s\n", value.c_str());
+				return 1;
+			}
+		}
+		else if (arg == "-s")
+			options.singletons = true;
+		else if (arg == "-d")
+			options.decompose = true;
+		else if (!input && arg[0] != '-')
+			input = argv[i];
+		else
+		{
+			printf("Usage: %s [-i hash|btree] [-c scan|probe|fused] [-g bfs|2sat|reverse|zdd|split|median] [-s] [-d] file\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (!input)
 	{
 		printf("Need filename to process.\n");
 		return 1;
 	}
 
 	try {
-		string file(argv[1]);
-		PhylogeneticLoader ldr;
+		string file(input);
+		PhylogeneticLoader ldr(options);
 
-		fs::path path = fs::path(argv[1]);
+		fs::path path = fs::path(input);
 		string filename = path.stem().string();
 
 		printf("%s: %s\n", path.filename().generic_u8string().c_str(), filename.c_str());
@@ -166,6 +201,9 @@ void PhylogeneticLoader::parse (const string& file)
 
 	partitions0.resize(m);
 	partitions1.resize(m);
+	columns.resize(m);
+	for (size_t j = 0; j < m; j++)
+		columns[j] = j;
 
 	try {
 		read(fp);
@@ -175,7 +213,7 @@ void PhylogeneticLoader::parse (const string& file)
 	}
 	fclose(fp);
 
-	printf("Found %zu unique taxas. ", nodes.size());
+	printf("Found %zu unique taxas. ", taxa.size());
 	fflush(stdout);
 
 	weight.resize(m, 1);
@@ -187,343 +225,426 @@ void PhylogeneticLoader::parse (const string& file)
 	printf("reduced to %" PRIu64 " haplotypes. ", m);
 	printf("Possible total: %le\n", pow((double) k, (double) m));
 
-	terminals = nodes.size();
+	if (options.decompose && decompose())
+	{
+		timer.stop();
+		return;
+	}
 
 	generate();
 
-	printf("Connecting vertices...\n");
-
-	connect();
-
 	timer.stop();
-
-	printf("Total vertices %zu, total edges %zu\n", nodes.size(), edges.size());
 }
 
-void PhylogeneticLoader::preprocess ()
+void PhylogeneticLoader::generate ()
 {
-	vector<int64_t> action(m, -1);
+	terminals = taxa.size();
 
-	for (size_t i = 0; i < m; i++)
+	// without conflicting columns the Buneman-Graph is the tree itself
+	unique_ptr<PerfectPhylogeny> tree(new PerfectPhylogeny(m, weight));
+	if (tree->build(taxa))
 	{
-		if (partitions0[i].none())
-		{
-#ifdef DEBUG
-			printf("delete column %zu reason: all TRUE\n", i);
-#endif
-			action[i] = -2;
-			continue;
-		}
-
-		if (partitions1[i].none())
+		graph = move(tree);
+		taxa.clear();
+		if (options.progress)
 		{
-#ifdef DEBUG
-			printf("delete column %zu reason: all FALSE\n", i);
-#endif
-			action[i] = -2;
-			continue;
+			printf("Found a perfect phylogeny.\n");
+			printf("Total vertices %zu, total edges %zu\n", graph->vertices(), graph->edges());
 		}
-
-		if (action[i] == -1)
-			for (size_t j = i + 1; j < m; j++)
-			{
-				if ((partitions0[i] == partitions0[j]) || (partitions0[i] == partitions1[j]))
-				{
-#ifdef DEBUG
-					printf("delete column %zu reason: equivalency w/ column %zu\n", j, i);
-#endif
-					assert(i < numeric_limits<int64_t>::max());
-					action[j] = i;
-				}
-			}
+		return;
 	}
 
-	auto it0 = partitions0.begin();
-	auto it1 = partitions1.begin();
-	size_t rem = 0;
-	for (size_t c = 0; c < m; c++)
+	// the diagram is counted right away and written without storing the vertices
+	if (options.generator == Options::Generator::zdd)
 	{
-
-		if (action[c] == -2)
+		unique_ptr<BunemanDiagram> diagram(new BunemanDiagram(m, weight));
+		diagram->build(taxa);
+		const size_t size = diagram->size();
+		graph = move(diagram);
+		taxa.clear();
+		if (options.progress)
 		{
-			it0 = partitions0.erase(it0);
-			it1 = partitions1.erase(it1);
-			for (node_type n : nodes)
-			{
-				n->remove(c - rem);
-			}
-			rem++;
-		}
-		else if (action[c] >= 0)
-		{
-			weight[action[c]]++;
-			it0 = partitions0.erase(it0);
-			it1 = partitions1.erase(it1);
-			for (node_type n : nodes)
-			{
-				n->remove(c - rem);
-			}
-			rem++;
-		}
-		else
-		{
-			it0++;
-			it1++;
+			printf("Decision diagram with %zu nodes.\n", size);
+			printf("Total vertices %zu, total edges %zu\n", graph->vertices(), graph->edges());
 		}
+		return;
 	}
 
-	// Erase the weight vector in a second pass to keep the action references
-	auto w = weight.begin();
-	for (size_t c = 0; c < m; c++)
+	// pick the narrowest taxon representation for the reduced matrix
+	switch (bits::words(m))
 	{
-		if (action[c] == -2 || action[c] >= 0)
-		{
-			w = weight.erase(w);
-		}
+	case 0:
+	case 1:
+		graph.reset(build<FixedTaxon<1>>());
+		break;
+	case 2:
+		graph.reset(build<FixedTaxon<2>>());
+		break;
+	case 3:
+	case 4:
+		graph.reset(build<FixedTaxon<4>>());
+		break;
+	case 5:
+	case 6:
+	case 7:
+	case 8:
+		graph.reset(build<FixedTaxon<8>>());
+		break;
+	default:
+		// more columns than the 16 bits of an Edge can refer to
+		if (m > EDGE_MAX_COLUMNS)
+			graph.reset(build<Taxon, WideEdge>());
 		else
-		{
-			w++;
-		}
+			graph.reset(build<Taxon>());
+		break;
 	}
 
-	for (node_type n : nodes)
-	{
-		n->resize();
-	}
+	graph->generate();
 
-	m = count_if(action.begin(), action.end(), [] (const int a)
-	{
-		return (a == -1);
-	});
+	if (options.progress)
+		printf("Connecting vertices...\n");
 
-	//timer.stop();
+	graph->connect();
 
+	if (options.progress)
+		printf("Total vertices %zu, total edges %zu\n", graph->vertices(), graph->edges());
 }
 
-void PhylogeneticLoader::generate ()
+template <class T, class E>
+Graph* PhylogeneticLoader::build ()
 {
-	uint64_t generated = 0;
-	struct lock_t
+	switch (options.index)
 	{
-		shared_mutex buneman;
-		shared_mutex queue;
-		shared_mutex node_set;
-		condition_variable_any empty;
-	};
-	lock_t locks;
-	deque<node_type> queue;
+	case Options::Index::btree:
+		return build<T, OrderedNodeIndex, E>();
+	case Options::Index::hash:
+	default:
+		return build<T, NodeIndex, E>();
+	}
+}
+
+template <class T, template <std::size_t> class I, class E>
+Graph* PhylogeneticLoader::build ()
+{
+	BunemanGraph<T, I, E>* g = new BunemanGraph<T, I, E>(m, weight, options);
+	for (const Taxon& v : taxa)
+		g->insert(v);
+	taxa.clear();
+	return g;
+}
 
-	struct output_t
+bool PhylogeneticLoader::decompose ()
+{
+	// union find over the columns, joined if they fail the four gamete test
+	vector<size_t> parent(m);
+	for (size_t j = 0; j < m; j++)
+		parent[j] = j;
+	const function<size_t (size_t)> find = [&parent] (size_t j)
 	{
-		mutex mx;
-		condition_variable monitor;
-		bool condition = false;
+		while (parent[j] != j)
+			j = parent[j] = parent[parent[j]];
+		return j;
 	};
-	output_t output;
-	for (auto v : nodes)
-	{
-		queue.push_back(v);
-		//cout << *v << endl;
-	}
-	//queue.push_back(*nodes.begin());
-	//cout << **nodes.begin() << endl;
 
-	int pool_threads = 0; //m > 100 ? 0 : 1;
-	ThreadPool p(pool_threads);
+	for (size_t i = 0; i < m; i++)
+		for (size_t j = i + 1; j < m; j++)
+		{
+			if (find(i) == find(j))
+				continue;
+			if (partitions1[i].intersects(partitions1[j]) && partitions1[i].intersects(partitions0[j])
+					&& partitions0[i].intersects(partitions1[j]) && partitions0[i].intersects(partitions0[j]))
+				parent[find(i)] = find(j);
+		}
 
-	thread output_thread([&output, &locks, &p, &generated] ()
+	// columns compatible with all others form one part, its graph is a tree
+	vector<vector<size_t>> groups;
+	vector<size_t> compatible;
 	{
-		uint64_t last = 0;
-		while (true)
+		vector<size_t> members(m, 0);
+		for (size_t j = 0; j < m; j++)
+			members[find(j)]++;
+		vector<size_t> group(m, numeric_limits<size_t>::max());
+		for (size_t j = 0; j < m; j++)
 		{
-			unique_lock<decltype(output.mx)> lock(output.mx);
-			output.monitor.wait_for(lock, OUTPUT_TIMEOUT);
-
-			if (is_terminal())
+			const size_t r = find(j);
+			if (members[r] == 1)
 			{
-				goto_beginning_of_line();
+				compatible.push_back(j);
+				continue;
 			}
+			if (group[r] == numeric_limits<size_t>::max())
 			{
-				shared_lock<decltype(locks.queue)> lock(locks.queue);
-				printf("%10" PRIu64 ": queued: %10zu    V/s: %5" PRIu64, generated, p.queued(), (generated-last) * OUTPUT_MULTIPLIER);
+				group[r] = groups.size();
+				groups.emplace_back();
 			}
-			last = generated;
-			if (is_terminal())
-				fflush(stdout);
-			else
-				printf("\n");
-
-			if (output.condition)
-				break;
+			groups[group[r]].push_back(j);
 		}
-	});
+	}
+	if (!compatible.empty())
+		groups.push_back(compatible);
+
+	if (groups.size() < 2)
+		return false;
+
+	printf("Decomposed into %zu independent parts\n", groups.size());
 
-	const function<void (node_type)> expand = [this, &locks, &queue, &generated, &p] (const node_type &v)
+	for (size_t g = 0; g < groups.size(); g++)
 	{
-		if (v.get() == nullptr) return;
-		for (size_t j = 0; j < m; j++)
+		const vector<size_t>& keep = groups[g];
+		unique_ptr<PhylogeneticLoader> part(new PhylogeneticLoader(options));
+		part->component = true;
+		part->options.decompose = false;
+		// small parts run side by side, one worker each, and their progress lines would mix
+		if (keep.size() <= SMALL_PART_COLUMNS)
 		{
-			node_type v1(new Taxon(*v.get()));
-			//cout << *v << endl;
-			v1->flip(j);
-			//cout << *v1 << " ";
-			{
-				shared_lock<decltype(locks.node_set)> lock(locks.node_set);
-				//cout << nodes.count(v1) << endl;
-				if (nodes.count(v1) > 0)
-					continue;
-			}
-			shared_lock<decltype(locks.buneman)> lock(locks.buneman);
-			bool b = isBuneman(v1, j);
-			//cout << (b ? "OK" : "--") << endl;
-			lock.unlock();
-			if (b)
-			{
-				{
-					unique_lock<decltype(locks.node_set)> lock(locks.node_set);
-					nodes.insert(v1);
-				}
-				{
-					unique_lock<decltype(locks.buneman)> lock(locks.buneman);
-					insertBuneman(v1);
-				}
-				{
-					unique_lock<decltype(locks.queue)> lock(locks.queue);
-					queue.push_back(v1);
-					generated++;
-				}
-			}
+			part->options.threads = 1;
+			part->options.progress = false;
+		}
+		part->k = k;
+		part->m = keep.size();
+		for (size_t j : keep)
+		{
+			part->columns.push_back(columns[j]);
+			part->weight.push_back(weight[j]);
 		}
-		locks.empty.notify_one();
+		part->taxa.reserve(taxa.size());
+		for (const Taxon& t : taxa)
+		{
+			part->taxa.emplace_back(keep.size());
+			Taxon& v = part->taxa.back();
+			for (size_t j = 0; j < keep.size(); j++)
+				if (t.at(keep[j]))
+					v.flip(j);
+		}
+		sort(part->taxa.begin(), part->taxa.end());
+		part->taxa.erase(unique(part->taxa.begin(), part->taxa.end()), part->taxa.end());
+		part->n = part->taxa.size();
+		part->partitions0.resize(part->m);
+		part->partitions1.resize(part->m);
+		for (const Taxon& v : part->taxa)
+			part->insertBuneman(v);
+
+		printf("Part %zu: %zu taxas, %" PRIu64 " haplotypes\n", g + 1, part->taxa.size(), part->m);
+		parts.push_back(move(part));
+	}
+	taxa.clear();
+
+	const function<void (PhylogeneticLoader*)> solve = [] (PhylogeneticLoader* l)
+	{
+		l->timer.start();
+		l->preprocess();
+		l->generate();
+		l->timer.stop();
 	};
 
-	do
+	// Every part has its own loader and graph. The small parts are generated in
+	// parallel, at most one per hardware thread, the others one after another
+	// with all threads each, so the pools of the parts never multiply.
 	{
-		bool stop = false;
-		node_type v;
+		vector<PhylogeneticLoader*> small;
+		for (unique_ptr<PhylogeneticLoader>& part : parts)
+			if (part->m <= SMALL_PART_COLUMNS)
+				small.push_back(part.get());
+		if (!small.empty())
 		{
-			unique_lock<decltype(locks.queue)> lock(locks.queue);
-			while (queue.empty())
-			{
-				locks.empty.wait(lock);
-				if (queue.empty() && p.queued() == 0)
+			ThreadPool p(min(small.size(), options.workers()));
+			vector<future<void>> done;
+			for (PhylogeneticLoader* l : small)
+				done.push_back(p.enqueue<void>([&solve, l] ()
 				{
-					stop = true;
-					break;
-				}
-			}
-			if (stop)
-				break;
-			v = queue.front();
-			queue.pop_front();
-			p.enqueue<void>([v, &expand] ()
-			{
-				expand(v);
-			});
+					solve(l);
+				}));
+			// rethrows an error of a part
+			for (future<void>& f : done)
+				f.get();
+			p.shutdown();
 		}
 	}
-	while (true);
+	for (size_t g = 0; g < parts.size(); g++)
+		if (parts[g]->m > SMALL_PART_COLUMNS)
+		{
+			printf("Part %zu:\n", g + 1);
+			solve(parts[g].get());
+		}
 
-	p.shutdown();
+	for (size_t g = 0; g < parts.size(); g++)
+		printf("Part %zu: total vertices %zu, total edges %zu\n", g + 1, parts[g]->graph->vertices(), parts[g]->graph->edges());
+	return true;
+}
+
+void PhylogeneticLoader::preprocess ()
+{
+	// removing columns can make taxa equal, and merging taxa can make new
+	// columns removable, so reduce until neither changes anything
+#ifdef DEBUG
+	size_t round = 0;
+#endif
+	// one pool for all rounds, every round projects the taxa on it
+	ThreadPool p(options.workers());
+	while (true)
 	{
-		unique_lock<decltype(output.mx)> lock(output.mx);
-		output.condition = true;
-		output.monitor.notify_one();
+		const bool reducedColumns = reduceColumns(p);
+		const bool reducedRows = reducedColumns && reduceRows();
+#ifdef DEBUG
+		printf("reduction round %zu: %" PRIu64 " columns, %zu taxa\n", ++round, m, taxa.size());
+#endif
+		if (!reducedRows)
+			break;
 	}
-	output_thread.join();
-	printf("\n");
+}
 
-	printf("Generated %" PRIu64 " latent taxas. ", generated);
-	fflush(stdout);
+bool PhylogeneticLoader::reduceRows ()
+{
+	const size_t before = taxa.size();
+	sort(taxa.begin(), taxa.end());
+	taxa.erase(unique(taxa.begin(), taxa.end()), taxa.end());
+	if (taxa.size() == before)
+		return false;
+
+	// the partitions have one bit per taxon
+	partitions0.assign(m, boost::dynamic_bitset<>());
+	partitions1.assign(m, boost::dynamic_bitset<>());
+	for (const Taxon& v : taxa)
+		insertBuneman(v);
+	return true;
 }
 
-void PhylogeneticLoader::connect ()
+bool PhylogeneticLoader::reduceColumns (ThreadPool& p)
 {
-	uint64_t index = 1;
-	for (auto x : nodes)
-		x->Index = index++;
-	auto i = nodes.begin();
-	atomic<uint64_t> counter(0);
-	shared_mutex edges_lock;
-	mutex output;
-	condition_variable output_monitor;
-	bool end = false;
-
-	thread output_thread([this, &end, &counter, &output, &index, &edges_lock, &output_monitor] ()
+	vector<int64_t> action(m, -1);
+
+	// Columns are equivalent if they split the taxa the same way, i.e. if they
+	// are equal or complementary. Normalized so the first taxon is in state 0
+	// equivalent columns are equal, so one pass over a hash table finds the
+	// first column of every class.
+	typedef boost::dynamic_bitset<> column_t;
+	struct column_hash
 	{
-		uint64_t last_e = 0;
-		uint64_t last_v = 0;
-		uint64_t e;
-		double idx = index - 1;
-		while (true)
+		// boost::hash_value of a dynamic_bitset is missing from older Boost releases
+		size_t operator() (const column_t* c) const
 		{
-			unique_lock<decltype(output)> lock(output);
-			output_monitor.wait_for(lock, OUTPUT_TIMEOUT);
-			if (is_terminal())
-				goto_beginning_of_line();
-			{
-				shared_lock<decltype(edges_lock)> lock_e(edges_lock);
-				e = edges.size();
-			}
-			//cout << setw(10) << e << ": " << setw(6) << counter << " / " << setw(6) << index - 1;
-			printf("%10" PRIu64 ": %6.2lf%%  E/s: %5" PRIu64 "   V/s: %5" PRIu64,
-				e,
-				(counter / idx) * 100,
-				(e-last_e) * OUTPUT_MULTIPLIER,
-				(counter-last_v) * OUTPUT_MULTIPLIER
-			);
-			last_e = e;
-			last_v = counter;
-			if (is_terminal())
-				fflush(stdout);
-			else
-				printf("\n");
-
-			if (end)
-				break;
+			vector<column_t::block_type> blocks(c->num_blocks());
+			boost::to_block_range(*c, blocks.begin());
+			size_t h = 0;
+			for (const column_t::block_type b : blocks)
+				boost::hash_combine(h, b);
+			return h;
 		}
-	});
+	};
+	struct column_equal
+	{
+		bool operator() (const column_t* a, const column_t* b) const
+		{
+			return *a == *b;
+		}
+	};
+	unordered_map<const column_t*, size_t, column_hash, column_equal> first;
+	first.reserve(m);
 
-	ThreadPool p(0);
-	while (i != nodes.end())
+	for (size_t i = 0; i < m; i++)
 	{
-		p.enqueue<void>([this, &edges_lock, i, &counter] ()
+		if (partitions0[i].none())
 		{
-			auto m = i;
-			m++;
-			while (m != nodes.end())
-			{
-				if ((**i).distance(**m) == 1)
-				{
-					size_t d = (**i).difference(**m);
-					{
-						unique_lock<decltype(edges_lock)> l(edges_lock);
-						edges.emplace_back(*i, *m, weight[d]);
-					}
-				}
-				m++;
-			}
+#ifdef DEBUG
+			printf("delete column %zu reason: all TRUE\n", i);
+#endif
+			action[i] = -2;
+			continue;
+		}
+
+		if (partitions1[i].none())
+		{
+#ifdef DEBUG
+			printf("delete column %zu reason: all FALSE\n", i);
+#endif
+			action[i] = -2;
+			continue;
+		}
 
-			counter++;
+		const column_t* normal = partitions1[i][0] ? &partitions0[i] : &partitions1[i];
+		auto found = first.emplace(normal, i);
+		if (!found.second)
+		{
+#ifdef DEBUG
+			printf("delete column %zu reason: equivalency w/ column %zu\n", i, found.first->second);
+#endif
+			assert(found.first->second < (size_t) numeric_limits<int64_t>::max());
+			action[i] = found.first->second;
+		}
+		else if (options.singletons && (partitions0[i].count() == 1 || partitions1[i].count() == 1))
+		{
+#ifdef DEBUG
+			printf("delete column %zu reason: singleton\n", i);
+#endif
+			action[i] = -3;
+		}
+	}
 
-		});
-		i++;
+	// columns that stay, in their old order
+	vector<size_t> keep;
+	for (size_t c = 0; c < m; c++)
+	{
+		if (action[c] == -1)
+			keep.push_back(c);
+		else if (action[c] >= 0)
+			weight[action[c]] += weight[c];
+	}
+
+	// a singleton column adds one pendant edge to the taxon it separates
+	for (size_t c = 0; c < m; c++)
+	{
+		if (action[c] != -3)
+			continue;
+		const size_t t = partitions0[c].count() == 1 ? partitions0[c].find_first() : partitions1[c].find_first();
+		pendants.push_back(Pendant{taxa[t], columns[c], weight[c]});
+		offset += weight[c];
+	}
+
+	vector<size_t> kept_columns(keep.size());
+	vector<uint64_t> kept_weight(keep.size());
+	vector<boost::dynamic_bitset<>> kept0(keep.size());
+	vector<boost::dynamic_bitset<>> kept1(keep.size());
+	for (size_t i = 0; i < keep.size(); i++)
+	{
+		kept_columns[i] = columns[keep[i]];
+		kept_weight[i] = weight[keep[i]];
+		kept0[i].swap(partitions0[keep[i]]);
+		kept1[i].swap(partitions1[keep[i]]);
 	}
+	columns.swap(kept_columns);
+	weight.swap(kept_weight);
+	partitions0.swap(kept0);
+	partitions1.swap(kept1);
 
-	p.shutdown();
+	// project the taxa in one pass, split into ranges over the threads
 	{
-		unique_lock<decltype(output)> lock(output);
-		end = true;
-		output_monitor.notify_one();
+		const size_t tasks = options.workers();
+		const size_t range = (taxa.size() + tasks - 1) / tasks;
+		vector<future<void>> done;
+		for (size_t from = 0; from < taxa.size(); from += range)
+		{
+			const size_t to = min(from + range, taxa.size());
+			done.push_back(p.enqueue<void>([this, &keep, from, to] ()
+			{
+				for (size_t i = from; i < to; i++)
+					taxa[i].project(keep);
+			}));
+		}
+		for (future<void>& f : done)
+			f.get();
 	}
-	output_thread.join();
-	cout << endl;
+	for (Pendant& e : pendants)
+		e.taxon.project(keep);
+
+	const bool changed = keep.size() != m;
+	m = keep.size();
+	return changed;
 }
 
-void PhylogeneticLoader::insertBuneman (const node_type& v)
+void PhylogeneticLoader::insertBuneman (const Taxon& v)
 {
 	for (size_t j = 0; j < m; j++)
-		if (v->at(j))
+		if (v.at(j))
 		{
 			partitions1[j].push_back(true);
 			partitions0[j].push_back(false);
@@ -535,36 +656,28 @@ void PhylogeneticLoader::insertBuneman (const node_type& v)
 		}
 }
 
-bool PhylogeneticLoader::isBuneman (const node_type& v, const size_t j) const
+void PhylogeneticLoader::write (const string& name)
 {
-	auto& p = (v->at(j) ? partitions1[j] : partitions0[j]);
+	char filename[name.length() + 5];
 
-	for (size_t l = 0; l < m; l++)
-		if (l == j)
-			continue;
-		else if (!p.intersects(v->at(l) ? partitions1[l] : partitions0[l]))
-		return false;
-    /*for (int j = 0; j < m; j++)
-    		for (int l = j + 1; l < m; l++)
-    			if (!(v->at(j) ? partitions1[j] : partitions0[j]).intersects(v->at(l) ? partitions1[l] : partitions0[l]))
-    				return false;*/
-	return true;
-}
+	// one file for every part, the map of the whole input tells how they fit together
+	for (size_t i = 0; i < parts.size(); i++)
+		parts[i]->write(name + "." + to_string(i + 1));
 
-void PhylogeneticLoader::write (const string& name)
-{
-	char filename[name.length() + 4];
-	sprintf(filename, "%s.stp", name.c_str());
-	
-	// open in untranslated mode so windows does not make \r\n in each line
-	FILE* stp = fopen(filename, "wb");
-	if (!stp)
+	if (parts.empty())
 	{
-		printf("Could not open %s for writing.\n", filename);
-		throw runtime_error("Could not open output file.");
+		sprintf(filename, "%s.stp", name.c_str());
+
+		// open in untranslated mode so windows does not make \r\n in each line
+		FILE* stp = fopen(filename, "wb");
+		if (!stp)
+		{
+			printf("Could not open %s for writing.\n", filename);
+			throw runtime_error("Could not open output file.");
+		}
+		write(stp, name);
+		fclose(stp);
 	}
-	write(stp, name);
-	fclose(stp);
 
 	sprintf(filename, "%s.map", name.c_str());
 	FILE* map = fopen(filename, "wb");
@@ -573,21 +686,54 @@ void PhylogeneticLoader::write (const string& name)
 		printf("Could not open %s for writing.\n", filename);
 		throw runtime_error("Could not open output file.");
 	}
-	writemap(map);
+	if (parts.empty())
+		writemap(map);
+	else
+		writeparts(map, name);
 	fclose(map);
 }
 
 void PhylogeneticLoader::writemap (FILE* __restrict fp)
 {
-	fprintf(fp, "%zu\n", nodes.size());
+	fprintf(fp, "%zu\n", graph->vertices());
 	fprintf(fp, "%" PRIu64 "\n", m);
 	fprintf(fp, "%" PRIu64 "\n", k);
-	for (auto v : nodes)
+	graph->write_vertices(fp);
+	if (component)
+		writecolumns(fp);
+	writependants(fp);
+}
+
+void PhylogeneticLoader::writeparts (FILE* __restrict fp, const string& name)
+{
+	fprintf(fp, "%zu\n", parts.size());
+	for (size_t i = 0; i < parts.size(); i++)
+		fprintf(fp, "%s.%zu\n", name.c_str(), i + 1);
+	fprintf(fp, "%" PRIu64 "\n", m);
+	writecolumns(fp);
+	writependants(fp);
+}
+
+void PhylogeneticLoader::writecolumns (FILE* __restrict fp)
+{
+	// input column of every column of the taxa
+	for (size_t j = 0; j < m; j++)
+		fprintf(fp, j ? "\t%zu" : "%zu", columns[j]);
+	fputc('\n', fp);
+}
+
+void PhylogeneticLoader::writependants (FILE* __restrict fp)
+{
+	if (!options.singletons)
+		return;
+	// pendant edges: number and total weight, then one line per edge with the
+	// terminal it hangs off, the input column (from 0) and the weight
+	fprintf(fp, "%zu\t%" PRIu64 "\n", pendants.size(), offset);
+	for (const Pendant& e : pendants)
 	{
-		fprintf(fp, "%" PRIu64 "\t", v->Index);
-		v->print(fp);
-		fprintf(fp, (v->Terminal ? "\tterminal" : ""));
-		fputc('\n', fp);
+		for (size_t j = 0; j < m; j++)
+			fputc(e.taxon.at(j) ? '1' : '0', fp);
+		fprintf(fp, "\t%zu\t%" PRIu64 "\n", e.column, e.weight);
 	}
 }
 
@@ -603,23 +749,22 @@ void PhylogeneticLoader::write (FILE* __restrict fp, const string& name)
 	fprintf(fp, "END\n\n");
 
 	fprintf(fp, "SECTION Graph\n");
-	fprintf(fp, "Nodes %zu\n", nodes.size());
-	fprintf(fp, "Edges %zu\n", edges.size());
-	for (auto e : edges)
-		fprintf(fp, "E %" PRIu64 " %" PRIu64 " %" PRIu64 "\n", get<0>(e)->Index, get<1>(e)->Index, get<2>(e));
+	fprintf(fp, "Nodes %zu\n", graph->vertices());
+	fprintf(fp, "Edges %zu\n", graph->edges());
+	graph->write_edges(fp);
 	fprintf(fp, "END\n\n");
 
 	fprintf(fp, "SECTION Terminals\n");
 	fprintf(fp, "Terminals %" PRIu64 "\n", terminals);
-	for (auto x : nodes)
-		if (x->Terminal)
-			fprintf(fp, "T %" PRIu64 "\n", x->Index);
+	graph->write_terminals(fp);
 	fprintf(fp, "END\n\n");
 
 	fprintf(fp, "SECTION Presolve\n");
 	time_t t = time(nullptr);
 	fprintf(fp, "Date %s", ctime(&t));;
 	fprintf(fp, "Time %lf\n", timer.elapsed().getSeconds());
+	if (options.singletons)
+		fprintf(fp, "Fixed %" PRIu64 "\n", offset);
 	fprintf(fp, "END\n\n");
 	fprintf(fp, "EOF\n");
 }
@@ -663,15 +808,15 @@ void PhylogeneticLoader::read (FILE* __restrict fp)
 			throw runtime_error("Format error in input file.");
 		}
 
-		node_type v(new Taxon(taxon, m));
-		//bool inserted;
-		//decltype(nodes)::iterator it;
-		//tie(it, inserted) = nodes.insert(v);
-
-		auto inserted = nodes.insert(v);
-		if (get<1>(inserted))
-			insertBuneman(v);
+		taxa.emplace_back((const char*) taxon, m);
 	}
+
+	// drop duplicate taxa
+	sort(taxa.begin(), taxa.end());
+	taxa.erase(unique(taxa.begin(), taxa.end()), taxa.end());
+
+	for (const Taxon& v : taxa)
+		insertBuneman(v);
 }
 
 void PhylogeneticLoader::write_timer ()
@@ -684,12 +829,15 @@ void PhylogeneticLoader::write_timer ()
 	printf("       Speed up: %5.3lf\n", speedup);
 }
 
-PhylogeneticLoader::PhylogeneticLoader ()
+PhylogeneticLoader::PhylogeneticLoader (const Options& options) :
+		options(options),
+		component(false)
 {
 	n = 0;
 	m = 0;
 	k = 0;
 	terminals = 0;
+	offset = 0;
 }
 
 PhylogeneticLoader::~PhylogeneticLoader ()
@@ -11,7 +11,6 @@
 
 #include "def.hpp"
 #include <cstdio>
-#include <deque>
 #include <vector>
 #include <string>
 #include <memory>
@@ -21,9 +20,11 @@
 
 #include <boost/dynamic_bitset.hpp>
 
-#include "btree/btree_set.h"
 #include "Timer.hpp"
+#include "Options.hpp"
 #include "Taxon.hpp"
+#include "ThreadPool.hpp"
+#include "BunemanGraph.hpp"
 
 #define PROGRAM_NAME "Phylogeny Converter"
 #define PROGRAM_VERSION "1.0"
@@ -33,7 +34,7 @@
 class PhylogeneticLoader
 {
 public:
-	PhylogeneticLoader ();
+	PhylogeneticLoader (const Options& = Options());
 	virtual ~PhylogeneticLoader ();
 
 	/// Parse and generate Function
@@ -45,27 +46,9 @@ public:
 	void write_timer();
 
 private:
-	/// Data type for nodes
-	typedef std::shared_ptr<Taxon> node_type;
-
 	Timer timer;
 
-	/// Unwrap shared_ptr for comparisons
-	struct less
-	{
-	public:
-		inline bool operator() (const node_type lhs, const node_type rhs) const noexcept
-		{
-			return *lhs < *rhs;
-		}
-	};
-
-	/// Set of nodes
-	typedef btree::btree_set<node_type, less> node_set;
-	/// Data type for edges
-	typedef std::tuple<node_type, node_type, uint64_t> edge_type;
-	/// List of generated edges
-	typedef std::deque<edge_type> edge_list;
+	Options options;
 
 	/// Number of Taxas in input matrix
 	uint64_t n;
@@ -79,8 +62,32 @@ private:
 	/// Taxon from the input
 	uint64_t terminals;
 
-	node_set nodes;
-	edge_list edges;
+	/// Unique taxa from the input, sorted
+	std::vector<Taxon> taxa;
+
+	/// input column of each remaining column
+	std::vector<std::size_t> columns;
+
+	/// Edge from a terminal to a taxon that was removed with a singleton column
+	struct Pendant
+	{
+		/// the terminal, reduced like the other taxa
+		Taxon taxon;
+		/// input column the removed taxon differs in
+		std::size_t column;
+		uint64_t weight;
+	};
+	std::vector<Pendant> pendants;
+	/// total weight of the pendant edges
+	uint64_t offset;
+
+	/// Buneman-Graph of the reduced input
+	std::unique_ptr<Graph> graph;
+
+	/// independent parts of the input, if it was decomposed
+	std::vector<std::unique_ptr<PhylogeneticLoader>> parts;
+	/// this is a part of a decomposed input
+	bool component;
 
 	/// partition data for Buneman-Graph 0 blocks
 	std::vector<boost::dynamic_bitset<>> partitions0;
@@ -93,18 +100,32 @@ private:
 	void write (FILE* __restrict, const std::string&);
 	/// write mapping information (to reconstruct original Phylogeny)
 	void writemap (FILE* __restrict);
+	/// write the parts of a decomposed input instead of a mapping
+	void writeparts (FILE* __restrict, const std::string&);
+	/// write the input column of each column
+	void writecolumns (FILE* __restrict);
+	/// write the pendant edges of removed singleton columns
+	void writependants (FILE* __restrict);
 
-	/// generate the Buneman-Graph
-	void generate ();
-	/// Check the Buneman condition for a given node, j is the bit that changed
-	bool isBuneman (const node_type&, const size_t j) const;
 	/// insert a node into the Buneman data structure, for initialization
-	void insertBuneman (const node_type&);
+	void insertBuneman (const Taxon&);
 
-	/// Generate the edges
-	void connect();
-	/// Row reduction
+	/// Reduce rows and columns until nothing changes
 	void preprocess();
+	/// Remove constant columns and merge equivalent ones, true if a column was removed
+	bool reduceColumns(ThreadPool&);
+	/// Merge equal taxa, true if a taxon was removed
+	bool reduceRows();
+	/// Split the columns into components of the incompatibility graph, true if there are several
+	bool decompose();
+	/// Generate and connect the Buneman-Graph of the reduced taxa
+	void generate();
+	/// Create the Buneman-Graph for taxa of type T and edges of type E with the selected index
+	template <class T, class E = Edge>
+	Graph* build ();
+	/// Create the Buneman-Graph for taxa of type T, index I and edges of type E from the reduced input
+	template <class T, template <std::size_t> class I, class E>
+	Graph* build ();
 
 };
 
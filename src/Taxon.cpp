@@ -12,6 +12,8 @@
 #include <stdexcept>
 #include <string>
 #include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
@@ -19,37 +21,48 @@
 
 using namespace std;
 
-void Taxon::remove(const size_t pos)
+void Taxon::project(const vector<size_t>& columns)
 {
-	if (pos >= size)
+	__internal_t* projected = (__internal_t*) calloc(bits::words(columns.size()) ? bits::words(columns.size()) : 1, sizeof(__internal_t));
+	for (size_t k = 0; k < columns.size(); k++)
 	{
-		throw logic_error("Position out of bounds");
-	}
-	if (pos < size - 1)
-	{
-		move(internal + pos + 1, internal + size , internal + pos);
+		if (columns[k] >= size)
+		{
+			free(projected);
+			throw logic_error("Position out of bounds");
+		}
+		if (at(columns[k]))
+			bits::flip(projected, k);
 	}
-	size = size - 1;
+	free(internal);
+	internal = projected;
+	size = columns.size();
+	fingerprint = zobrist::fingerprint<0>(internal, words());
 }
 
-void Taxon::resize()
+const size_t Taxon::length () const noexcept
 {
-  internal = (__internal_t*) realloc(internal, size);
-  //internal.resize(size);
+	return size;
 }
 
-const size_t Taxon::length () const noexcept
+size_t Taxon::words () const noexcept
 {
-	return size;
+	return bits::words(size);
 }
 
-const size_t Taxon::hash () const noexcept
+const bits::word_t* Taxon::data () const noexcept
 {
-	size_t hash = 0;
-	for (size_t i = 0; i < size; i++)
-		hash ^= (internal[i] << i);
+	return internal;
+}
+
+bits::word_t* Taxon::data () noexcept
+{
+	return internal;
+}
 
-	return hash;
+const size_t Taxon::hash () const noexcept
+{
+	return (size_t) fingerprint;
 }
 
 const size_t Taxon::difference (const Taxon& other) const
@@ -59,10 +72,7 @@ const size_t Taxon::difference (const Taxon& other) const
 		throw logic_error("Taxas do not have the same length");
 	}
 
-	for (size_t i = 0; i < size; i++)
-		if (internal[i] != other.internal[i])
-			return i;
-	return -1;
+	return bits::difference<0>(internal, other.internal, words());
 }
 
 const size_t Taxon::distance (const Taxon& other) const
@@ -72,13 +82,7 @@ const size_t Taxon::distance (const Taxon& other) const
 		throw logic_error("Taxas do not have the same length");
 	}
 
-	size_t distance = 0;
-
-	for (size_t i = 0; i < size; i++)
-		if (internal[i] != other.internal[i])
-			distance++;
-	return distance;
-
+	return bits::distance<0>(internal, other.internal, words());
 }
 
 bool Taxon::operator< (const Taxon& other) const noexcept
@@ -86,80 +90,139 @@ bool Taxon::operator< (const Taxon& other) const noexcept
 	if (other.size != size)
 		return false;
 
-	for (size_t i = 0; i < size; i++)
-		if (internal[i] != other.internal[i])
-			return internal[i];
+	return bits::less<0>(internal, other.internal, words());
+}
+
+void Taxon::assign(const bits::word_t* __restrict src, const size_t __len)
+{
+	// keep the buffer if the number of words does not change
+	if (words() != bits::words(__len))
+	{
+		free(internal);
+		internal = (__internal_t*) malloc(bits::words(__len) * sizeof(__internal_t));
+	}
+	size = __len;
+	memcpy(internal, src, words() * sizeof(__internal_t));
+	fingerprint = zobrist::fingerprint<0>(internal, words());
+}
 
-	return false;
+void Taxon::set(const size_t pos, const bool value) noexcept
+{
+	const __internal_t mask = __internal_t(1) << (pos % bits::word_bits);
+	if (value != at(pos))
+		fingerprint ^= zobrist::key(pos);
+	if (value)
+		internal[pos / bits::word_bits] |= mask;
+	else
+		internal[pos / bits::word_bits] &= ~mask;
 }
 
 void Taxon::flip(const size_t pos)
 {
-	internal[pos] = !internal[pos];
+	bits::flip(internal, pos);
+	fingerprint ^= zobrist::key(pos);
 }
 
 bool Taxon::operator== (const Taxon& other) const noexcept
 {
 	if (other.size != size)
 		return false;
-	for (size_t i = 0; i < size; i++)
-	{
-		if (internal[i] != other.internal[i])
-			return false;
-	}
-
-	return true;
+	return bits::equal<0>(internal, other.internal, words());
 }
 
-bool& Taxon::operator[] (size_t pos) noexcept
+bool Taxon::operator[] (size_t pos) const noexcept
 {
-	return internal[pos];
+	return at(pos);
 }
 
-bool Taxon::operator[] (size_t pos) const noexcept
+bool Taxon::at (size_t pos) const noexcept
 {
-	return internal[pos];
+	return bits::at(internal, pos);
 }
 
-bool& Taxon::at (size_t pos) noexcept
+void Taxon::print (FILE* __restrict fp)
 {
-	return internal[pos];
+	for (size_t i = 0; i < size; i++)
+		fputc(at(i) ? '1' : '0', fp);
 }
 
-bool Taxon::at (size_t pos) const noexcept
+Taxon& Taxon::operator= (const Taxon& other)
 {
-	return internal[pos];
+	if (this == &other)
+		return *this;
+
+	if (words() != other.words())
+	{
+		free(internal);
+		internal = (__internal_t*) malloc(other.words() * sizeof(__internal_t));
+	}
+	size = other.size;
+	memcpy(internal, other.internal, words() * sizeof(__internal_t));
+	fingerprint = other.fingerprint;
+	Terminal = other.Terminal;
+	Index = other.Index;
+
+	return *this;
 }
 
-void Taxon::print (FILE* __restrict fp)
+Taxon& Taxon::operator= (Taxon&& other) noexcept
 {
-	for (size_t i = 0; i < size; i++)
-		fputc(internal[i] ? '1' : '0', fp);
+	swap(internal, other.internal);
+	swap(size, other.size);
+	fingerprint = other.fingerprint;
+	Terminal = other.Terminal;
+	Index = other.Index;
+
+	return *this;
 }
 
-Taxon::Taxon (const Taxon& other) :
+Taxon::Taxon () :
 			Terminal(false),
 			Index(0),
-			size(other.size)
+			internal(nullptr),
+			size(0),
+			fingerprint(0)
 {
-  internal = (__internal_t*) malloc(size);
+}
 
-	for (size_t i = 0; i < size; i++)
-	{
-		internal[i] = other.internal[i];
-	}
+Taxon::Taxon (const Taxon& other) :
+			Terminal(other.Terminal),
+			Index(other.Index),
+			size(other.size),
+			fingerprint(other.fingerprint)
+{
+	internal = (__internal_t*) malloc(words() * sizeof(__internal_t));
+	memcpy(internal, other.internal, words() * sizeof(__internal_t));
+}
 
+Taxon::Taxon (Taxon&& other) noexcept :
+			Terminal(other.Terminal),
+			Index(other.Index),
+			internal(other.internal),
+			size(other.size),
+			fingerprint(other.fingerprint)
+{
+	other.internal = nullptr;
+	other.size = 0;
 }
 
 Taxon::Taxon (const size_t n) :
 			Terminal(false),
 			Index(0),
-			size(n)
+			size(n),
+			fingerprint(0)
 {
-	internal = (__internal_t*) malloc(size);
+	internal = (__internal_t*) calloc(words(), sizeof(__internal_t));
+}
 
-	for (size_t i = 0; i < size; i++)
-		internal[i] = false;
+Taxon::Taxon (const bits::word_t* __restrict src, const size_t __len) :
+			Terminal(false),
+			Index(0),
+			size(__len)
+{
+	internal = (__internal_t*) malloc(words() * sizeof(__internal_t));
+	memcpy(internal, src, words() * sizeof(__internal_t));
+	fingerprint = zobrist::fingerprint<0>(internal, words());
 }
 
 Taxon::Taxon (const char * __restrict bitstring, const size_t __len) :
@@ -169,13 +232,9 @@ Taxon::Taxon (const char * __restrict bitstring, const size_t __len) :
 	{
 		if (bitstring[j] == '1')
 		{
-			internal[j] = true;
-		}
-		else if (bitstring[j] == '0')
-		{
-			internal[j] = false;
+			set(j, true);
 		}
-		else
+		else if (bitstring[j] != '0')
 		{
 			throw out_of_range("Taxon bitstring is neither 0 or 1");
 		}
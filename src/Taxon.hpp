@@ -10,33 +10,45 @@
 #define TAXON_HPP_
 
 #include "def.hpp"
+#include "Bits.hpp"
+#include "Zobrist.hpp"
 #include <string>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <memory>
+#include <vector>
 
 class Taxon
 {
 public:
+	/// the number of words is only known at runtime
+	static constexpr std::size_t Words = 0;
+
+	Taxon ();
 	Taxon (const Taxon&);
+	Taxon (Taxon&&) noexcept;
 	Taxon (const std::size_t);
 	Taxon (const char * __restrict, const std::size_t);
+	Taxon (const bits::word_t* __restrict, const std::size_t);
 	virtual ~Taxon ();
 
-	bool& operator[] (std::size_t pos) noexcept;
 	bool operator[] (std::size_t pos) const noexcept;
 
-	bool& at (std::size_t pos) noexcept;
 	bool at (std::size_t pos) const noexcept;
 
+	/// overwrite with a packed bit string of the given length
+	void assign(const bits::word_t* __restrict, const std::size_t);
+
+	void set(const std::size_t pos, const bool value) noexcept;
 	void flip(const std::size_t pos);
 
 	void print(FILE* __restrict);
 
 	bool operator== (const Taxon&) const noexcept;
 	bool operator< (const Taxon&) const noexcept;
-	Taxon& operator= (const Taxon& other) = default;
+	Taxon& operator= (const Taxon& other);
+	Taxon& operator= (Taxon&& other) noexcept;
 
 	/// get hamming distance
 	const std::size_t distance (const Taxon& other) const;
@@ -44,18 +56,25 @@ public:
 	/// get first occurance of diverging bit
 	const std::size_t difference (const Taxon& other) const;
 	const std::size_t length () const noexcept;
+	/// number of storage words
+	std::size_t words () const noexcept;
+	/// raw access to the packed bits, bit i is bit (i % 64) of word (i / 64)
+	const bits::word_t* data () const noexcept;
+	bits::word_t* data () noexcept;
+	/// Zobrist fingerprint, kept up to date by every modification
 	const std::size_t hash() const noexcept;
-	void remove(const std::size_t);
-	void resize();
+	/// keep only the given columns, in the given order
+	void project(const std::vector<std::size_t>&);
 
 	bool Terminal;
 
 	uint64_t Index;
 
 private:
-	typedef bool __internal_t;
+	typedef bits::word_t __internal_t;
 	__internal_t* internal;
 	std::size_t size;
+	zobrist::fingerprint_t fingerprint;
 };
 
 #endif /* TAXON_HPP_ */
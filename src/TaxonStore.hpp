@@ -0,0 +1,154 @@
+/**
+ * \file
+ * \brief Append only storage for the bits of all vertices
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef TAXONSTORE_HPP_
+#define TAXONSTORE_HPP_
+
+#include "def.hpp"
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "Bits.hpp"
+#include "Zobrist.hpp"
+
+/**
+ * Arena of taxa addressed by 32 bit vertex ids. Each taxon is a row of words
+ * (W words if W > 0, otherwise the number given to the constructor), followed
+ * by its Zobrist fingerprint.
+ *
+ * The rows live in chunks of doubling size, chunk k holding 2^(k + base)
+ * rows, so rows never move once written and readers need no lock. Appending
+ * is thread safe, a row may be read by any thread that obtained its id
+ * through a synchronized hand over.
+ */
+template <std::size_t W>
+class TaxonStore
+{
+public:
+	typedef uint32_t id_type;
+
+	/// id that is never handed out
+	static constexpr id_type none = UINT32_MAX;
+
+	TaxonStore (const std::size_t words) :
+			stride(bits::span<W>(words)),
+			count(0)
+	{
+		for (std::size_t k = 0; k < chunks; k++)
+			chunk[k] = nullptr;
+	}
+
+	TaxonStore (const TaxonStore&) = delete;
+	TaxonStore& operator= (const TaxonStore&) = delete;
+
+	virtual ~TaxonStore ()
+	{
+		for (std::size_t k = 0; k < chunks; k++)
+			delete[] chunk[k].load();
+	}
+
+	/// copy the first n words of a taxon with fingerprint fp into a new row, missing words are 0
+	id_type append (const bits::word_t* __restrict src, const std::size_t n, const zobrist::fingerprint_t fp)
+	{
+		const uint64_t id = count.fetch_add(1);
+		if (id >= none)
+		{
+			throw std::overflow_error("Too many vertices for 32 bit ids");
+		}
+
+		bits::word_t* dst = reserve((id_type) id);
+		const std::size_t len = n < stride ? n : stride;
+		std::memcpy(dst, src, len * sizeof(bits::word_t));
+		std::memset(dst + len, 0, (stride - len) * sizeof(bits::word_t));
+		dst[stride] = fp;
+
+		return (id_type) id;
+	}
+
+	const bits::word_t* operator[] (const id_type id) const noexcept
+	{
+		std::size_t k, offset;
+		locate(id, k, offset);
+		return chunk[k].load(std::memory_order_acquire) + offset * pitch();
+	}
+
+	bits::word_t* operator[] (const id_type id) noexcept
+	{
+		std::size_t k, offset;
+		locate(id, k, offset);
+		return chunk[k].load(std::memory_order_acquire) + offset * pitch();
+	}
+
+	zobrist::fingerprint_t fingerprint (const id_type id) const noexcept
+	{
+		return (*this)[id][bits::span<W>(stride)];
+	}
+
+	/// number of rows handed out
+	std::size_t size () const noexcept
+	{
+		return (std::size_t) count.load();
+	}
+
+	/// number of words per row
+	std::size_t words () const noexcept
+	{
+		return stride;
+	}
+
+private:
+	/// the first chunk has 2^base rows
+	static constexpr std::size_t base = 10;
+	/// enough chunks to address every 32 bit id
+	static constexpr std::size_t chunks = 33 - base;
+
+	const std::size_t stride;
+	std::atomic<uint64_t> count;
+
+	std::atomic<bits::word_t*> chunk[chunks];
+	std::mutex grow;
+
+	/// words per row including the fingerprint
+	std::size_t pitch () const noexcept
+	{
+		return bits::span<W>(stride) + 1;
+	}
+
+	static void locate (const id_type id, std::size_t& k, std::size_t& offset) noexcept
+	{
+		const uint64_t t = (uint64_t) id + (uint64_t(1) << base);
+		const std::size_t msb = bits::word_bits - 1 - bits::clz(t);
+		k = msb - base;
+		offset = (std::size_t) (t - (uint64_t(1) << msb));
+	}
+
+	/// address of row id, allocating its chunk on first use
+	bits::word_t* reserve (const id_type id)
+	{
+		std::size_t k, offset;
+		locate(id, k, offset);
+		bits::word_t* c = chunk[k].load(std::memory_order_acquire);
+		if (c == nullptr)
+		{
+			std::unique_lock<std::mutex> lock(grow);
+			c = chunk[k].load(std::memory_order_relaxed);
+			if (c == nullptr)
+			{
+				c = new bits::word_t[(std::size_t(1) << (k + base)) * pitch()];
+				chunk[k].store(c, std::memory_order_release);
+			}
+		}
+		return c + offset * pitch();
+	}
+};
+
+#endif /* TAXONSTORE_HPP_ */
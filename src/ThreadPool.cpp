@@ -33,6 +33,7 @@ using namespace std;
 
 // the constructor just launches some amount of workers
 ThreadPool::ThreadPool (size_t threads) :
+			running(0),
 			stop(false)
 {
 	if (threads == 0)
@@ -45,12 +46,17 @@ ThreadPool::ThreadPool (size_t threads) :
 
 size_t ThreadPool::queued()
 {
-	return tasks.size();
+	unique_lock<mutex> lock(queue_mutex);
+	return tasks.size() + running;
 }
 
 void ThreadPool::shutdown ()
 {
-	stop = true;
+	{
+		// under the lock, so no worker misses the notification between its check and its wait
+		unique_lock<mutex> lock(queue_mutex);
+		stop = true;
+	}
 	condition.notify_all();
 	for (size_t i = 0; i < workers.size(); ++i)
 		workers[i].join();
@@ -81,7 +87,10 @@ void ThreadPool::Worker::operator() ()
 			return;
 		function<void ()> task(std::move(pool.tasks.front()));
 		pool.tasks.pop();
+		pool.running++;
 		lock.unlock();
 		task();
+		lock.lock();
+		pool.running--;
 	}
 }
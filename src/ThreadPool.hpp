@@ -44,6 +44,7 @@ public:
 	template <class T, class F>
 	std::future<T> enqueue (const F f);
 
+	// tasks waiting or running
 	size_t queued();
 	void shutdown ();
 	virtual ~ThreadPool ();
@@ -68,6 +69,9 @@ private:
 	// the task queue
 	std::queue<std::function<void ()>> tasks;
 
+	// tasks taken by a worker and not finished yet
+	size_t running;
+
 	// Synchronisation
 	std::mutex queue_mutex;
 	std::condition_variable condition;
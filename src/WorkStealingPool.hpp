@@ -0,0 +1,263 @@
+/**
+ * \file
+ * \brief Work stealing scheduler for irregular, self spawning work
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef WORKSTEALINGPOOL_HPP_
+#define WORKSTEALINGPOOL_HPP_
+
+#include "def.hpp"
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+
+#if __linux__
+#include <sys/prctl.h>
+#endif
+
+/**
+ * Pool of workers processing items of type T, where processing an item may
+ * produce new items. Every worker owns a deque: items pushed by a worker go
+ * into its own deque and are taken from the back again (depth first, the data
+ * is still in cache), idle workers steal from the front of the deques of the
+ * others. There is no central queue, the workers only touch shared state when
+ * they run out of work.
+ *
+ * Termination is detected exactly with a counter of outstanding items: an
+ * item counts from its push until f returned for it. f pushes the items it
+ * produces before its own item is finished, so the counter can only drop to
+ * zero when no item is queued or in progress anywhere, and then no new item
+ * can appear. The worker that finishes the last item wakes the others.
+ *
+ * If f throws, the first exception stops all workers, and run() rethrows it
+ * on the calling thread once they are joined.
+ */
+template <class T>
+class WorkStealingPool
+{
+public:
+	typedef T item_type;
+
+	/// threads = 0 uses one worker per hardware thread
+	WorkStealingPool (std::size_t threads) :
+			seed(0),
+			pending(0),
+			sleepers(0),
+			failed(false),
+			done(false)
+	{
+		if (threads == 0)
+			threads = std::thread::hardware_concurrency();
+		if (threads == 0)
+			threads = 1;
+		for (std::size_t i = 0; i < threads; i++)
+			queues.emplace_back(new queue);
+	}
+
+	WorkStealingPool (const WorkStealingPool&) = delete;
+	WorkStealingPool& operator= (const WorkStealingPool&) = delete;
+
+	/**
+	 * Add an item. From inside a worker the item goes into the deque of that
+	 * worker, otherwise the items are spread round robin.
+	 */
+	void push (const T& item)
+	{
+		std::size_t i = current.pool == this ? current.id : seed++ % queues.size();
+		pending++;
+		{
+			std::unique_lock<std::mutex> lock(queues[i]->mx);
+			queues[i]->items.push_back(item);
+		}
+		// a sleeper registers before it looks at the deques a last time, so
+		// either it sees this item or this sees the sleeper
+		if (sleepers.load() > 0)
+		{
+			std::unique_lock<std::mutex> lock(sleep_mutex);
+			sleeping.notify_one();
+		}
+	}
+
+	/// process all items with f, including the ones pushed by f, then return or rethrow the error of f
+	template <class F>
+	void run (F f)
+	{
+		done = pending == 0;
+		std::vector<std::thread> workers;
+		for (std::size_t i = 1; i < queues.size(); i++)
+			workers.emplace_back([this, i, &f] ()
+			{
+#if __linux__
+				prctl(PR_SET_NAME, "WSworker");
+#endif
+				work(i, f);
+			});
+		work(0, f);
+		for (std::thread& t : workers)
+			t.join();
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+	/// items waiting in any deque, only a snapshot while running
+	std::size_t queued () const
+	{
+		std::size_t n = 0;
+		for (const auto& q : queues)
+		{
+			std::unique_lock<std::mutex> lock(q->mx);
+			n += q->items.size();
+		}
+		return n;
+	}
+
+	/// number of workers
+	std::size_t threads () const noexcept
+	{
+		return queues.size();
+	}
+
+	/// id of the calling worker in 0 .. threads() - 1, only valid inside f
+	std::size_t worker () const noexcept
+	{
+		return current.id;
+	}
+
+private:
+	struct queue
+	{
+		mutable std::mutex mx;
+		std::deque<T> items;
+	};
+
+	/// worker the calling thread belongs to
+	struct context
+	{
+		const void* pool;
+		std::size_t id;
+	};
+
+	static thread_local context current;
+
+	std::vector<std::unique_ptr<queue>> queues;
+	/// next deque for items pushed from outside
+	std::atomic<std::size_t> seed;
+
+	/// items pushed and not finished
+	std::atomic<std::size_t> pending;
+	/// workers waiting for work
+	std::atomic<std::size_t> sleepers;
+	/// set when f threw, the workers stop taking items
+	std::atomic<bool> failed;
+	/// first exception thrown by f, set under sleep_mutex
+	std::exception_ptr error;
+	/// set under sleep_mutex when the last item is finished
+	bool done;
+	std::mutex sleep_mutex;
+	std::condition_variable sleeping;
+
+	template <class F>
+	void work (const std::size_t id, F& f)
+	{
+		current = context{this, id};
+		uint64_t rng = id * 0x9E3779B97F4A7C15ULL + 1;
+		T item;
+		while (!failed && (pop(id, item) || steal(id, rng, item) || wait(id, rng, item)))
+		{
+			try
+			{
+				f(item);
+			}
+			catch (...)
+			{
+				fail(std::current_exception());
+				break;
+			}
+			if (--pending == 0)
+				finish();
+		}
+		current = context{nullptr, 0};
+	}
+
+	/// take the newest item of the own deque
+	bool pop (const std::size_t id, T& item)
+	{
+		queue& q = *queues[id];
+		std::unique_lock<std::mutex> lock(q.mx);
+		if (q.items.empty())
+			return false;
+		item = q.items.back();
+		q.items.pop_back();
+		return true;
+	}
+
+	/// take the oldest item of another deque, starting at a random victim
+	bool steal (const std::size_t id, uint64_t& rng, T& item)
+	{
+		const std::size_t n = queues.size();
+		rng ^= rng << 13;
+		rng ^= rng >> 7;
+		rng ^= rng << 17;
+		const std::size_t start = rng % n;
+		for (std::size_t k = 0; k < n; k++)
+		{
+			const std::size_t victim = (start + k) % n;
+			if (victim == id)
+				continue;
+			queue& q = *queues[victim];
+			std::unique_lock<std::mutex> lock(q.mx);
+			if (q.items.empty())
+				continue;
+			item = q.items.front();
+			q.items.pop_front();
+			return true;
+		}
+		return false;
+	}
+
+	/// Sleep until there is work again. Returns false once all items are finished.
+	bool wait (const std::size_t id, uint64_t& rng, T& item)
+	{
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		sleepers++;
+		bool found = false;
+		while (!done && !(found = pop(id, item) || steal(id, rng, item)))
+			sleeping.wait(lock);
+		sleepers--;
+		return found;
+	}
+
+	/// wake all workers after the last item
+	void finish ()
+	{
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		done = true;
+		sleeping.notify_all();
+	}
+
+	/// keep the first exception and stop all workers, items left are dropped
+	void fail (std::exception_ptr e)
+	{
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		if (!error)
+			error = e;
+		failed = true;
+		done = true;
+		sleeping.notify_all();
+	}
+};
+
+template <class T>
+thread_local typename WorkStealingPool<T>::context WorkStealingPool<T>::current = {nullptr, 0};
+
+#endif /* WORKSTEALINGPOOL_HPP_ */
@@ -0,0 +1,49 @@
+/**
+ * \file
+ * \brief Zobrist fingerprints of packed taxa
+ *
+ * \date 2026-10-17
+ */
+
+#ifndef ZOBRIST_HPP_
+#define ZOBRIST_HPP_
+
+#include "def.hpp"
+#include <cstddef>
+#include <cstdint>
+
+#include "Bits.hpp"
+
+/*
+ * The fingerprint of a taxon is the XOR of a random key for every set bit.
+ * Flipping bit j changes the fingerprint by key(j), so it can be maintained
+ * in O(1) while a taxon is modified.
+ */
+namespace zobrist
+{
+
+typedef uint64_t fingerprint_t;
+
+/// random key of character j (splitmix64 with a fixed seed, so runs are reproducible)
+inline fingerprint_t key (const std::size_t j) noexcept
+{
+	uint64_t z = (uint64_t) j * 0x9E3779B97F4A7C15ULL + 0x2545F4914F6CDD1DULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/// fingerprint of a packed bit string, computed from scratch
+template <std::size_t W>
+inline fingerprint_t fingerprint (const bits::word_t* __restrict a, const std::size_t n = W) noexcept
+{
+	fingerprint_t h = 0;
+	for (std::size_t i = 0; i < bits::span<W>(n); i++)
+		for (bits::word_t x = a[i]; x; x &= x - 1)
+			h ^= key(i * bits::word_bits + bits::ctz(x));
+	return h;
+}
+
+}
+
+#endif /* ZOBRIST_HPP_ */
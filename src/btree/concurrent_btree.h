@@ -0,0 +1,449 @@
+// A concurrent B+-tree using optimistic lock coupling (Leis et al., "The ART
+// of Practical Synchronization", DaMoN 2016).
+//
+// Every node carries a version latch. Readers never write shared memory: they
+// remember the version of a node, read it and validate afterwards that the
+// version did not change, restarting the operation from the root otherwise.
+// Writers upgrade the latch of the leaf they modify, and when a node has to
+// be split, the latches of that node and its parent. Full inner nodes are
+// split eagerly on the way down, so a split never propagates upwards.
+//
+// Nodes are never removed while the tree is alive, so an optimistic reader
+// can always dereference a child pointer it has read. Keys and child pointers
+// are accessed atomically (acquire/release), so a key read by an optimistic
+// reader is always a value that has been fully published by some writer.
+// This makes it safe to use keys that are handles into other storage. Key
+// must be trivially copyable, and the comparator must accept a value
+// initialized Key, which is what unused slots hold.
+//
+// Only insertion and lookup are supported concurrently. Iteration (for_each)
+// and destruction must not run concurrently with writers.
+
+#ifndef UTIL_BTREE_CONCURRENT_BTREE_H__
+#define UTIL_BTREE_CONCURRENT_BTREE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace btree {
+namespace olc {
+
+// Version latch of a node. Bit 1 is the lock bit, the bits above count the
+// modifications. Unlocking adds 2 to a locked version, which clears the lock
+// bit and increments the counter in one step.
+class version_latch {
+ public:
+  version_latch() : version_(0) {}
+
+  // Returns the current version, waiting while the node is locked.
+  uint64_t read_lock() const {
+    uint64_t v = version_.load(std::memory_order_acquire);
+    for (int spin = 0; v & kLocked; ++spin) {
+      if (spin > 64) {
+        std::this_thread::yield();
+      }
+      v = version_.load(std::memory_order_acquire);
+    }
+    return v;
+  }
+
+  // True if the node did not change since read_lock() returned v.
+  bool validate(uint64_t v) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == v;
+  }
+
+  // Locks the node if it did not change since read_lock() returned v.
+  bool upgrade(uint64_t v) {
+    return version_.compare_exchange_strong(v, v + kLocked,
+                                            std::memory_order_acquire);
+  }
+
+  void unlock() {
+    version_.fetch_add(kLocked, std::memory_order_release);
+  }
+
+ private:
+  static const uint64_t kLocked = 2;
+  std::atomic<uint64_t> version_;
+};
+
+}  // namespace olc
+
+template <typename Key, typename Compare, int TargetNodeSize>
+class concurrent_btree {
+  static_assert(std::is_trivially_copyable<Key>::value,
+                "concurrent_btree keys must be trivially copyable");
+
+  struct node_type;
+  struct leaf_type;
+  struct inner_type;
+
+ public:
+  typedef Key key_type;
+  typedef Compare key_compare;
+  typedef size_t size_type;
+
+  enum {
+    kNodeValues = (TargetNodeSize - 16) / sizeof(Key) > 4 ?
+        (TargetNodeSize - 16) / sizeof(Key) : 4,
+    kInnerValues = (TargetNodeSize - 16) / (sizeof(Key) + sizeof(void*)) > 4 ?
+        (TargetNodeSize - 16) / (sizeof(Key) + sizeof(void*)) : 4,
+  };
+
+  explicit concurrent_btree(const key_compare &comp)
+      : comp_(comp),
+        root_(new leaf_type),
+        size_(0) {
+  }
+
+  concurrent_btree(const concurrent_btree &) = delete;
+  concurrent_btree &operator=(const concurrent_btree &) = delete;
+
+  ~concurrent_btree() {
+    destroy(root_.load());
+  }
+
+  // Looks up a key equivalent to k and stores it in *key if there is one. K
+  // may be any type the comparator can compare with Key in both directions.
+  template <typename K>
+  bool find_unique(const K &k, Key *key) const {
+    for (;;) {
+      node_type *node;
+      uint64_t v;
+      if (!descend(k, &node, &v)) {
+        continue;
+      }
+      const leaf_type *leaf = static_cast<const leaf_type*>(node);
+      const int n = count(leaf, kNodeValues);
+      const int pos = lower_bound(leaf->keys, n, k);
+      const Key found = leaf->keys[pos < n ? pos : 0].load(
+          std::memory_order_acquire);
+      const bool equal = pos < n && !comp_(k, found);
+      if (leaf->latch.validate(v)) {
+        if (equal) {
+          *key = found;
+        }
+        return equal;
+      }
+    }
+  }
+
+  // Inserts the key returned by create() unless a key equivalent to k is
+  // already present. create() is called at most once, while the target leaf
+  // is locked. Returns the key in the tree and whether it was inserted.
+  template <typename K, typename Create>
+  std::pair<Key, bool> insert_unique(const K &k, Create create) {
+    for (;;) {
+      std::pair<Key, bool> result;
+      if (try_insert(k, create, &result)) {
+        return result;
+      }
+    }
+  }
+
+  // Number of keys in the tree.
+  size_type size() const {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  // Calls f for every key in ascending order.
+  template <typename F>
+  void for_each(F f) const {
+    visit(root_.load(), f);
+  }
+
+ private:
+  struct node_type {
+    explicit node_type(bool l) : leaf(l), count(0) {}
+    olc::version_latch latch;
+    const bool leaf;
+    std::atomic<int> count;
+  };
+
+  struct leaf_type : public node_type {
+    leaf_type() : node_type(true), keys() {}
+    std::atomic<Key> keys[kNodeValues];
+  };
+
+  // An inner node with count keys has count + 1 children. Child i holds the
+  // keys less than keys[i] and not less than keys[i - 1].
+  struct inner_type : public node_type {
+    inner_type() : node_type(false), keys(), children() {}
+    std::atomic<Key> keys[kInnerValues];
+    std::atomic<node_type*> children[kInnerValues + 1];
+  };
+
+  // Number of slots in use, clamped for optimistic readers.
+  static int count(const node_type *node, int capacity) {
+    const int c = node->count.load(std::memory_order_acquire);
+    return c < 0 ? 0 : (c > capacity ? capacity : c);
+  }
+
+  // First position whose key is not less than k.
+  template <typename K>
+  int lower_bound(const std::atomic<Key> *keys, int n, const K &k) const {
+    int lo = 0;
+    while (lo < n) {
+      const int mid = (lo + n) / 2;
+      if (comp_(keys[mid].load(std::memory_order_acquire), k)) {
+        lo = mid + 1;
+      } else {
+        n = mid;
+      }
+    }
+    return lo;
+  }
+
+  // First position whose key is greater than k.
+  template <typename K>
+  int upper_bound(const std::atomic<Key> *keys, int n, const K &k) const {
+    int lo = 0;
+    while (lo < n) {
+      const int mid = (lo + n) / 2;
+      if (!comp_(k, keys[mid].load(std::memory_order_acquire))) {
+        lo = mid + 1;
+      } else {
+        n = mid;
+      }
+    }
+    return lo;
+  }
+
+  // Walks down to the leaf for k with lock coupling. Returns false if the
+  // walk has to be restarted.
+  template <typename K>
+  bool descend(const K &k, node_type **leaf, uint64_t *version) const {
+    node_type *node = root_.load(std::memory_order_acquire);
+    uint64_t v = node->latch.read_lock();
+    if (node != root_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    while (!node->leaf) {
+      const inner_type *inner = static_cast<const inner_type*>(node);
+      const int pos = upper_bound(inner->keys, count(inner, kInnerValues), k);
+      node_type *child = inner->children[pos].load(std::memory_order_acquire);
+      if (!inner->latch.validate(v) || child == nullptr) {
+        return false;
+      }
+      const uint64_t vchild = child->latch.read_lock();
+      if (!inner->latch.validate(v)) {
+        return false;
+      }
+      node = child;
+      v = vchild;
+    }
+    *leaf = node;
+    *version = v;
+    return true;
+  }
+
+  template <typename K, typename Create>
+  bool try_insert(const K &k, Create &create, std::pair<Key, bool> *result) {
+    node_type *node = root_.load(std::memory_order_acquire);
+    uint64_t v = node->latch.read_lock();
+    if (node != root_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    inner_type *parent = nullptr;
+    uint64_t vparent = 0;
+
+    while (!node->leaf) {
+      inner_type *inner = static_cast<inner_type*>(node);
+      if (count(inner, kInnerValues) == kInnerValues) {
+        // split full inner nodes on the way down
+        split(parent, vparent, inner, v);
+        return false;
+      }
+      if (parent != nullptr && !parent->latch.validate(vparent)) {
+        return false;
+      }
+      const int pos = upper_bound(inner->keys, count(inner, kInnerValues), k);
+      node_type *child = inner->children[pos].load(std::memory_order_acquire);
+      if (!inner->latch.validate(v) || child == nullptr) {
+        return false;
+      }
+      const uint64_t vchild = child->latch.read_lock();
+      if (!inner->latch.validate(v)) {
+        return false;
+      }
+      parent = inner;
+      vparent = v;
+      node = child;
+      v = vchild;
+    }
+
+    leaf_type *leaf = static_cast<leaf_type*>(node);
+    if (count(leaf, kNodeValues) == kNodeValues) {
+      split(parent, vparent, leaf, v);
+      return false;
+    }
+    if (!leaf->latch.upgrade(v)) {
+      return false;
+    }
+
+    const int n = leaf->count.load(std::memory_order_relaxed);
+    const int pos = lower_bound(leaf->keys, n, k);
+    if (pos < n && !comp_(k, leaf->keys[pos].load(std::memory_order_acquire))) {
+      *result = std::make_pair(leaf->keys[pos].load(std::memory_order_relaxed),
+                               false);
+      leaf->latch.unlock();
+      return true;
+    }
+
+    const Key key = create();
+    for (int i = n; i > pos; --i) {
+      leaf->keys[i].store(leaf->keys[i - 1].load(std::memory_order_relaxed),
+                          std::memory_order_release);
+    }
+    leaf->keys[pos].store(key, std::memory_order_release);
+    leaf->count.store(n + 1, std::memory_order_release);
+    leaf->latch.unlock();
+    size_.fetch_add(1, std::memory_order_relaxed);
+
+    *result = std::make_pair(key, true);
+    return true;
+  }
+
+  // Splits node (read at version v) and inserts the separator into parent
+  // (read at version vparent) or a new root. Does nothing if one of the
+  // latches cannot be taken, the caller restarts in either case.
+  void split(inner_type *parent, uint64_t vparent, node_type *node,
+             uint64_t v) {
+    if (parent != nullptr && !parent->latch.upgrade(vparent)) {
+      return;
+    }
+    if (!node->latch.upgrade(v)) {
+      if (parent != nullptr) {
+        parent->latch.unlock();
+      }
+      return;
+    }
+    if (parent == nullptr && node != root_.load(std::memory_order_relaxed)) {
+      // another thread grew the tree above node
+      node->latch.unlock();
+      return;
+    }
+
+    Key separator;
+    node_type *right;
+    if (node->leaf) {
+      right = split_leaf(static_cast<leaf_type*>(node), &separator);
+    } else {
+      right = split_inner(static_cast<inner_type*>(node), &separator);
+    }
+
+    if (parent != nullptr) {
+      insert_child(parent, separator, right);
+    } else {
+      inner_type *root = new inner_type;
+      root->keys[0].store(separator, std::memory_order_relaxed);
+      root->children[0].store(node, std::memory_order_relaxed);
+      root->children[1].store(right, std::memory_order_relaxed);
+      root->count.store(1, std::memory_order_relaxed);
+      root_.store(root, std::memory_order_release);
+    }
+
+    node->latch.unlock();
+    if (parent != nullptr) {
+      parent->latch.unlock();
+    }
+  }
+
+  // Moves the upper half of a locked leaf into a new leaf.
+  node_type *split_leaf(leaf_type *leaf, Key *separator) {
+    leaf_type *right = new leaf_type;
+    const int n = leaf->count.load(std::memory_order_relaxed);
+    const int half = n / 2;
+    for (int i = half; i < n; ++i) {
+      right->keys[i - half].store(
+          leaf->keys[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    right->count.store(n - half, std::memory_order_relaxed);
+    leaf->count.store(half, std::memory_order_release);
+    *separator = right->keys[0].load(std::memory_order_relaxed);
+    return right;
+  }
+
+  // Moves the upper half of a locked inner node into a new node, the middle
+  // key moves up as separator.
+  node_type *split_inner(inner_type *inner, Key *separator) {
+    inner_type *right = new inner_type;
+    const int n = inner->count.load(std::memory_order_relaxed);
+    const int mid = n / 2;
+    for (int i = mid + 1; i < n; ++i) {
+      right->keys[i - mid - 1].store(
+          inner->keys[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    for (int i = mid + 1; i <= n; ++i) {
+      right->children[i - mid - 1].store(
+          inner->children[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    right->count.store(n - mid - 1, std::memory_order_relaxed);
+    *separator = inner->keys[mid].load(std::memory_order_relaxed);
+    inner->count.store(mid, std::memory_order_release);
+    return right;
+  }
+
+  // Adds a separator and its right child to a locked inner node with room.
+  void insert_child(inner_type *inner, const Key &separator,
+                    node_type *right) {
+    const int n = inner->count.load(std::memory_order_relaxed);
+    const int pos = upper_bound(inner->keys, n, separator);
+    for (int i = n; i > pos; --i) {
+      inner->keys[i].store(inner->keys[i - 1].load(std::memory_order_relaxed),
+                           std::memory_order_release);
+      inner->children[i + 1].store(
+          inner->children[i].load(std::memory_order_relaxed),
+          std::memory_order_release);
+    }
+    inner->keys[pos].store(separator, std::memory_order_release);
+    inner->children[pos + 1].store(right, std::memory_order_release);
+    inner->count.store(n + 1, std::memory_order_release);
+  }
+
+  template <typename F>
+  void visit(const node_type *node, F &f) const {
+    const int n = node->count.load(std::memory_order_relaxed);
+    if (node->leaf) {
+      const leaf_type *leaf = static_cast<const leaf_type*>(node);
+      for (int i = 0; i < n; ++i) {
+        f(leaf->keys[i].load(std::memory_order_relaxed));
+      }
+    } else {
+      const inner_type *inner = static_cast<const inner_type*>(node);
+      for (int i = 0; i <= n; ++i) {
+        visit(inner->children[i].load(std::memory_order_relaxed), f);
+      }
+    }
+  }
+
+  void destroy(node_type *node) {
+    if (node->leaf) {
+      delete static_cast<leaf_type*>(node);
+    } else {
+      inner_type *inner = static_cast<inner_type*>(node);
+      const int n = inner->count.load(std::memory_order_relaxed);
+      for (int i = 0; i <= n; ++i) {
+        destroy(inner->children[i].load(std::memory_order_relaxed));
+      }
+      delete inner;
+    }
+  }
+
+  key_compare comp_;
+  std::atomic<node_type*> root_;
+  std::atomic<size_type> size_;
+};
+
+}  // namespace btree
+
+#endif  // UTIL_BTREE_CONCURRENT_BTREE_H__
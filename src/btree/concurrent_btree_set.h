@@ -0,0 +1,75 @@
+// A concurrent_btree_set<> is a unique sorted set that many threads may insert
+// into and query at the same time, without a lock around the whole container.
+// See concurrent_btree.h for the synchronization scheme and its caveats.
+//
+// Unlike btree_set<> there are no iterators: keys are handed out by value and
+// the ordered traversal is done with for_each() once the writers are done.
+
+#ifndef UTIL_BTREE_CONCURRENT_BTREE_SET_H__
+#define UTIL_BTREE_CONCURRENT_BTREE_SET_H__
+
+#include <functional>
+#include <utility>
+
+#include "concurrent_btree.h"
+
+namespace btree {
+
+template <typename Key,
+          typename Compare = std::less<Key>,
+          int TargetNodeSize = 256>
+class concurrent_btree_set {
+  typedef concurrent_btree<Key, Compare, TargetNodeSize> btree_type;
+
+ public:
+  typedef typename btree_type::key_type key_type;
+  typedef typename btree_type::key_compare key_compare;
+  typedef typename btree_type::size_type size_type;
+
+ public:
+  // Default constructor.
+  concurrent_btree_set(const key_compare &comp = key_compare())
+      : tree_(comp) {
+  }
+
+  // Insertion routines.
+  std::pair<key_type, bool> insert(const key_type &x) {
+    return tree_.insert_unique(x, [&x]() { return x; });
+  }
+
+  // Inserts the key made by create() if no key equivalent to k is present.
+  // Lets callers probe with a lightweight type and only build the key when
+  // it is actually inserted.
+  template <typename K, typename Create>
+  std::pair<key_type, bool> insert(const K &k, Create create) {
+    return tree_.insert_unique(k, create);
+  }
+
+  // Lookup routines.
+  template <typename K>
+  bool find(const K &k, key_type *x) const {
+    return tree_.find_unique(k, x);
+  }
+  template <typename K>
+  size_type count(const K &k) const {
+    key_type x;
+    return tree_.find_unique(k, &x) ? 1 : 0;
+  }
+
+  // Size routines.
+  size_type size() const { return tree_.size(); }
+  bool empty() const { return tree_.size() == 0; }
+
+  // Calls f for every key in order. Must not run concurrently with insert.
+  template <typename F>
+  void for_each(F f) const {
+    tree_.for_each(f);
+  }
+
+ private:
+  btree_type tree_;
+};
+
+}  // namespace btree
+
+#endif  // UTIL_BTREE_CONCURRENT_BTREE_SET_H__
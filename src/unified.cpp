@@ -31,4 +31,7 @@
 #include "ThreadPool.cpp"
 #include "CPUTime.cpp"
 #include "Timer.cpp"
+#include "Console.cpp"
+#include "PerfectPhylogeny.cpp"
+#include "BunemanDiagram.cpp"
 #include "PhylogeneticLoader.cpp"